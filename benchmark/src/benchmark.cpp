@@ -0,0 +1,113 @@
+#include "benchmark.hh"
+#include <algorithm>
+#include <iostream>
+
+OffscreenTarget::OffscreenTarget() : fbo(0), texture(0), width(0), height(0) {}
+
+OffscreenTarget::~OffscreenTarget() { cleanup(); }
+
+bool OffscreenTarget::resize(int w, int h) {
+  if (fbo && w == width && h == height)
+    return true;
+  cleanup();
+
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               NULL);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenFramebuffers(1, &fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Offscreen target incomplete at " << w << "x" << h
+              << std::endl;
+    cleanup();
+    return false;
+  }
+
+  width = w;
+  height = h;
+  return true;
+}
+
+void OffscreenTarget::bind() {
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glViewport(0, 0, width, height);
+}
+
+void OffscreenTarget::cleanup() {
+  if (fbo) {
+    glDeleteFramebuffers(1, &fbo);
+    fbo = 0;
+  }
+  if (texture) {
+    glDeleteTextures(1, &texture);
+    texture = 0;
+  }
+  width = height = 0;
+}
+
+FrameTimer::FrameTimer() : frame(0) {}
+
+FrameTimer::~FrameTimer() { cleanup(); }
+
+bool FrameTimer::initialize(int frames) {
+  cleanup();
+  queries.resize(frames);
+  glGenQueries(frames, queries.data());
+  cpuMs.reserve(frames);
+  return frames > 0 && queries[0] != 0;
+}
+
+void FrameTimer::cleanup() {
+  if (!queries.empty())
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+  queries.clear();
+  cpuMs.clear();
+  frame = 0;
+}
+
+void FrameTimer::beginFrame() {
+  frameStart = std::chrono::steady_clock::now();
+  glBeginQuery(GL_TIME_ELAPSED, queries[frame]);
+}
+
+void FrameTimer::endFrame() {
+  glEndQuery(GL_TIME_ELAPSED);
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - frameStart;
+  cpuMs.push_back(elapsed.count());
+  frame++;
+}
+
+static void summarize(std::vector<double> &samples, double &mean,
+                      double &p95) {
+  mean = p95 = 0.0;
+  if (samples.empty())
+    return;
+  for (size_t i = 0; i < samples.size(); i++)
+    mean += samples[i];
+  mean /= samples.size();
+  std::sort(samples.begin(), samples.end());
+  p95 = samples[(samples.size() - 1) * 95 / 100];
+}
+
+void FrameTimer::finish(BenchmarkResult &result) {
+  std::vector<double> gpuMs(frame);
+  for (size_t i = 0; i < frame; i++) {
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &elapsed);
+    gpuMs[i] = static_cast<double>(elapsed) / 1.0e6;
+  }
+
+  result.frames = static_cast<int>(frame);
+  summarize(cpuMs, result.cpuMeanMs, result.cpuP95Ms);
+  summarize(gpuMs, result.gpuMeanMs, result.gpuP95Ms);
+  cpuMs.clear();
+  frame = 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "report.hh"
+#include <GL/glew.h>
+#include <chrono>
+#include <vector>
+
+// Color target the sweeps render into instead of a window, so the
+// resolution is whatever the configuration asks for
+class OffscreenTarget {
+private:
+  GLuint fbo;
+  GLuint texture;
+  int width;
+  int height;
+
+public:
+  OffscreenTarget();
+  ~OffscreenTarget();
+
+  bool resize(int w, int h); // Reallocates only when the size changes
+  void bind();               // Binds the FBO and sets the viewport
+  void cleanup();
+};
+
+// CPU and GPU time of a fixed run of frames. Each frame gets its own
+// GL_TIME_ELAPSED query, read back only after the run, so measuring never
+// stalls the pipeline in the middle of it.
+class FrameTimer {
+private:
+  std::vector<GLuint> queries;
+  std::vector<double> cpuMs;
+  std::chrono::steady_clock::time_point frameStart;
+  size_t frame;
+
+public:
+  FrameTimer();
+  ~FrameTimer();
+
+  bool initialize(int frames);
+  void cleanup();
+
+  void beginFrame();
+  void endFrame();
+
+  // Waits for the GPU and fills in the frame count and timing fields
+  void finish(BenchmarkResult &result);
+};
+
+#define COUNT_OF(array) (sizeof(array) / sizeof(array[0]))
+
+struct SweepOptions {
+  int frames;       // Timed frames per configuration
+  int warmupFrames; // Untimed frames before them
+};
+
+// Each sweep appends one result per configuration. Both expect a current
+// GL 3.3 context and load their shaders from shaders/ in the working
+// directory.
+bool runFireSweep(const SweepOptions &options,
+                  std::vector<BenchmarkResult> &results);
+bool runParticleSweep(const SweepOptions &options,
+                      std::vector<BenchmarkResult> &results);
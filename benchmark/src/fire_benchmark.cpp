@@ -0,0 +1,73 @@
+#include "benchmark.hh"
+#include "fire_shader.hh"
+#include <iostream>
+#include <sstream>
+
+// The keyboard presets of the demo, at the common output sizes
+static const int OCTAVES[] = {3, 6, 8};
+static const float SCALES[] = {2.0f, 3.0f, 4.0f};
+static const char *const NOISE_TYPES[] = {"simplex", "perlin"};
+static const int RESOLUTIONS[][2] = {{640, 360}, {1280, 720}, {1920, 1080}};
+
+bool runFireSweep(const SweepOptions &options,
+                  std::vector<BenchmarkResult> &results) {
+  FireShader fireShader;
+  OffscreenTarget target;
+  FrameTimer timer;
+  if (!fireShader.initialize() || !timer.initialize(options.frames)) {
+    std::cerr << "Fire benchmark initialization failed" << std::endl;
+    return false;
+  }
+
+  // Same state the demo sets up
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+  for (size_t r = 0; r < COUNT_OF(RESOLUTIONS); r++) {
+    int width = RESOLUTIONS[r][0];
+    int height = RESOLUTIONS[r][1];
+    if (!target.resize(width, height))
+      return false;
+
+    for (size_t o = 0; o < COUNT_OF(OCTAVES); o++) {
+      for (size_t s = 0; s < COUNT_OF(SCALES); s++) {
+        for (size_t n = 0; n < COUNT_OF(NOISE_TYPES); n++) {
+          fireShader.setOctaves(OCTAVES[o]);
+          fireShader.setScale(SCALES[s]);
+          fireShader.setNoiseType(static_cast<int>(n));
+          target.bind();
+
+          // Fixed time steps, so every run draws the same frames
+          int total = options.warmupFrames + options.frames;
+          for (int frame = 0; frame < total; frame++) {
+            bool timed = frame >= options.warmupFrames;
+            if (timed)
+              timer.beginFrame();
+            glClear(GL_COLOR_BUFFER_BIT);
+            fireShader.render(frame / 60.0f);
+            if (timed)
+              timer.endFrame();
+          }
+
+          std::ostringstream config;
+          config << "octaves=" << OCTAVES[o] << " scale=" << SCALES[s]
+                 << " noise=" << NOISE_TYPES[n] << " resolution=" << width
+                 << "x" << height;
+
+          BenchmarkResult result;
+          result.demo = "fire";
+          result.config = config.str();
+          timer.finish(result);
+          results.push_back(result);
+          std::cerr << "fire [" << result.config << "] gpu "
+                    << result.gpuMeanMs << " ms" << std::endl;
+        }
+      }
+    }
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  fireShader.cleanup();
+  return true;
+}
@@ -0,0 +1,146 @@
+#include "benchmark.hh"
+#include "report.hh"
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+void printUsage() {
+  std::cout << "Usage: FireBenchmark [options]\n"
+            << "  --demo fire|particles|all  Sweeps to run (default all)\n"
+            << "  --frames <n>               Timed frames per configuration "
+               "(default 120)\n"
+            << "  --warmup <n>               Untimed frames before them "
+               "(default 10)\n"
+            << "  --output <file>            Write the report to a file "
+               "instead of stdout\n"
+            << "  --baseline <file>          Compare against a stored report\n"
+            << "  --tolerance <percent>      Allowed slowdown before a "
+               "configuration counts as a regression (default 10)\n"
+            << "Run from the build directory, which holds the shaders."
+            << std::endl;
+}
+
+void errorCallback(int error, const char *description) {
+  std::cerr << "GLFW Error " << error << ": " << description << std::endl;
+}
+
+// An invisible window, only there to own the GL context; every sweep draws
+// into its own offscreen target
+GLFWwindow *createHiddenContext() {
+  glfwSetErrorCallback(errorCallback);
+  if (!glfwInit()) {
+    std::cerr << "Failed to initialize GLFW" << std::endl;
+    return nullptr;
+  }
+
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "Fire Benchmark", NULL, NULL);
+  if (!window) {
+    std::cerr << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return nullptr;
+  }
+  glfwMakeContextCurrent(window);
+  glfwSwapInterval(0);
+
+  glewExperimental = GL_TRUE;
+  GLenum err = glewInit();
+  if (err != GLEW_OK) {
+    std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(err)
+              << std::endl;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return nullptr;
+  }
+  return window;
+}
+
+int main(int argc, char **argv) {
+  const char *demo = "all";
+  const char *outputPath = nullptr;
+  const char *baselinePath = nullptr;
+  double tolerance = 10.0;
+  SweepOptions options;
+  options.frames = 120;
+  options.warmupFrames = 10;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--help")) {
+      printUsage();
+      return 0;
+    } else if (i + 1 >= argc) {
+      std::cerr << "Missing value for " << argv[i] << std::endl;
+      return -1;
+    } else if (!strcmp(argv[i], "--demo")) {
+      demo = argv[++i];
+    } else if (!strcmp(argv[i], "--frames")) {
+      options.frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--warmup")) {
+      options.warmupFrames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--output")) {
+      outputPath = argv[++i];
+    } else if (!strcmp(argv[i], "--baseline")) {
+      baselinePath = argv[++i];
+    } else if (!strcmp(argv[i], "--tolerance")) {
+      tolerance = atof(argv[++i]);
+    } else {
+      std::cerr << "Unknown option " << argv[i] << std::endl;
+      printUsage();
+      return -1;
+    }
+  }
+
+  bool runFire = !strcmp(demo, "fire") || !strcmp(demo, "all");
+  bool runParticles = !strcmp(demo, "particles") || !strcmp(demo, "all");
+  if ((!runFire && !runParticles) || options.frames <= 0 ||
+      options.warmupFrames < 0) {
+    printUsage();
+    return -1;
+  }
+
+  // Read the baseline first, a bad path should not cost a whole sweep
+  std::vector<BenchmarkResult> baseline;
+  if (baselinePath && !readReport(baselinePath, baseline))
+    return -1;
+
+  GLFWwindow *window = createHiddenContext();
+  if (!window)
+    return -1;
+  std::cerr << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  std::vector<BenchmarkResult> results;
+  bool ok = (!runFire || runFireSweep(options, results)) &&
+            (!runParticles || runParticleSweep(options, results));
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+  if (!ok)
+    return -1;
+
+  if (outputPath) {
+    if (!writeReport(outputPath, results))
+      return -1;
+  } else {
+    writeReport(std::cout, results);
+  }
+
+  if (baselinePath) {
+    // Progress and comparison go to stderr, stdout may be the report
+    int regressions =
+        compareReports(results, baseline, tolerance / 100.0, 0.05, std::cerr);
+    std::cerr << regressions << " regression(s) against " << baselinePath
+              << std::endl;
+    return regressions ? 1 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include "benchmark.hh"
+#include "particle.hh"
+#include "render_state.hh"
+#include "shader.hh"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <sstream>
+
+// Around the demo's 5000 particles and 150 px sprites
+static const int PARTICLE_COUNTS[] = {1000, 5000, 20000};
+static const float SPRITE_SCALES[] = {75.0f, 150.0f, 300.0f};
+
+struct BlendMode {
+  const char *name;
+  GLenum source;
+  GLenum destination;
+};
+
+static const BlendMode BLEND_MODES[] = {
+    {"alpha", GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA},
+    {"additive", GL_SRC_ALPHA, GL_ONE},
+};
+
+// The demo's window size, and a fixed emitter seed so runs are repeatable
+#define PARTICLE_WIDTH 1200
+#define PARTICLE_HEIGHT 900
+#define PARTICLE_SEED 1u
+
+bool runParticleSweep(const SweepOptions &options,
+                      std::vector<BenchmarkResult> &results) {
+  GLuint shader = createProgram("shaders/shader.vert", "shaders/shader.frag");
+  bindUniformBlock(shader, "FrameData", FRAME_BLOCK_BINDING);
+  GLint spriteScaleLoc = glGetUniformLocation(shader, "u_sprite_scale");
+
+  OffscreenTarget target;
+  FrameTimer timer;
+  if (!target.resize(PARTICLE_WIDTH, PARTICLE_HEIGHT) ||
+      !timer.initialize(options.frames)) {
+    std::cerr << "Particle benchmark initialization failed" << std::endl;
+    glDeleteProgram(shader);
+    return false;
+  }
+
+  RenderState state;
+  UniformBuffer frameBlock(sizeof(FrameData));
+  frameBlock.initialize();
+
+  glm::mat4 projection = glm::perspective(
+      glm::radians(45.0f), float(PARTICLE_WIDTH) / PARTICLE_HEIGHT, 0.1f,
+      100.f);
+  glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0, -0.5f, -4));
+  frameBlock.write(offsetof(FrameData, projection), &projection[0][0],
+                   sizeof(FrameData::projection));
+  frameBlock.write(offsetof(FrameData, view), &view[0][0],
+                   sizeof(FrameData::view));
+
+  GLuint vao, vbo;
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &vbo);
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Particle),
+                        (void *)(offsetof(Particle, size)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle),
+                        (void *)(offsetof(Particle, color)));
+  glEnableVertexAttribArray(2);
+
+  glEnable(GL_BLEND);
+  glEnable(GL_PROGRAM_POINT_SIZE);
+  glClearColor(0.02f, 0.02f, 0.05f, 1.0f);
+  target.bind();
+
+  std::vector<Particle> particles;
+  for (size_t c = 0; c < COUNT_OF(PARTICLE_COUNTS); c++) {
+    int count = PARTICLE_COUNTS[c];
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(Particle), nullptr,
+                 GL_DYNAMIC_DRAW);
+
+    for (size_t s = 0; s < COUNT_OF(SPRITE_SCALES); s++) {
+      for (size_t b = 0; b < COUNT_OF(BLEND_MODES); b++) {
+        state.useProgram(shader);
+        glUniform1f(spriteScaleLoc, SPRITE_SCALES[s]);
+        glBlendFunc(BLEND_MODES[b].source, BLEND_MODES[b].destination);
+
+        // Same seed and time step for every configuration, so each one
+        // simulates and draws the same particles
+        seedParticles(PARTICLE_SEED);
+        particles.assign(count, Particle());
+        for (auto &p : particles)
+          initParticle(p);
+
+        int total = options.warmupFrames + options.frames;
+        for (int frame = 0; frame < total; frame++) {
+          bool timed = frame >= options.warmupFrames;
+          if (timed)
+            timer.beginFrame();
+          glClear(GL_COLOR_BUFFER_BIT);
+
+          for (auto &p : particles)
+            updateParticle(p, 1.0f / 60.0f);
+          glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Particle),
+                          particles.data());
+
+          DrawCommand draw =
+              makeDrawCommand(shader, vao, GL_POINTS, (GLsizei)count);
+          draw.blocks[FRAME_BLOCK_BINDING] = &frameBlock;
+          state.draw(draw);
+          if (timed)
+            timer.endFrame();
+        }
+
+        std::ostringstream config;
+        config << "count=" << count << " sprite=" << SPRITE_SCALES[s]
+               << " blend=" << BLEND_MODES[b].name;
+
+        BenchmarkResult result;
+        result.demo = "particles";
+        result.config = config.str();
+        timer.finish(result);
+        results.push_back(result);
+        std::cerr << "particles [" << result.config << "] gpu "
+                  << result.gpuMeanMs << " ms" << std::endl;
+      }
+    }
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  frameBlock.cleanup();
+  glDeleteBuffers(1, &vbo);
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(shader);
+  return true;
+}
@@ -0,0 +1,135 @@
+#include "report.hh"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#define REPORT_HEADER                                                          \
+  "demo,config,frames,cpu_mean_ms,cpu_p95_ms,gpu_mean_ms,gpu_p95_ms"
+
+void writeReport(std::ostream &out,
+                 const std::vector<BenchmarkResult> &results) {
+  out << REPORT_HEADER << "\n" << std::fixed << std::setprecision(4);
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchmarkResult &r = results[i];
+    out << r.demo << "," << r.config << "," << r.frames << "," << r.cpuMeanMs
+        << "," << r.cpuP95Ms << "," << r.gpuMeanMs << "," << r.gpuP95Ms
+        << "\n";
+  }
+  out.flush();
+}
+
+bool writeReport(const char *path,
+                 const std::vector<BenchmarkResult> &results) {
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "Report open error: " << path << std::endl;
+    return false;
+  }
+  writeReport(file, results);
+  return static_cast<bool>(file);
+}
+
+bool readReport(const char *path, std::vector<BenchmarkResult> &results) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Report open error: " << path << std::endl;
+    return false;
+  }
+
+  std::string line;
+  if (!std::getline(file, line) || line != REPORT_HEADER) {
+    std::cerr << "Not a benchmark report: " << path << std::endl;
+    return false;
+  }
+
+  int lineNumber = 1;
+  while (std::getline(file, line)) {
+    lineNumber++;
+    if (line.empty())
+      continue;
+
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ','))
+      fields.push_back(field);
+    if (fields.size() != 7) {
+      std::cerr << "Malformed report line " << lineNumber << ": " << path
+                << std::endl;
+      return false;
+    }
+
+    BenchmarkResult r;
+    r.demo = fields[0];
+    r.config = fields[1];
+    r.frames = std::atoi(fields[2].c_str());
+    r.cpuMeanMs = std::atof(fields[3].c_str());
+    r.cpuP95Ms = std::atof(fields[4].c_str());
+    r.gpuMeanMs = std::atof(fields[5].c_str());
+    r.gpuP95Ms = std::atof(fields[6].c_str());
+    results.push_back(r);
+  }
+  return true;
+}
+
+static bool isRegression(double current, double base, double tolerance,
+                         double minDeltaMs) {
+  return current > base * (1.0 + tolerance) && current - base >= minDeltaMs;
+}
+
+static double percentChange(double current, double base) {
+  return base > 0.0 ? (current - base) / base * 100.0 : 0.0;
+}
+
+int compareReports(const std::vector<BenchmarkResult> &results,
+                   const std::vector<BenchmarkResult> &baseline,
+                   double tolerance, double minDeltaMs, std::ostream &out) {
+  int regressions = 0;
+  out << std::fixed << std::setprecision(3);
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchmarkResult &r = results[i];
+    const BenchmarkResult *base = NULL;
+    for (size_t j = 0; j < baseline.size() && !base; j++) {
+      if (baseline[j].demo == r.demo && baseline[j].config == r.config)
+        base = &baseline[j];
+    }
+
+    out << r.demo << " [" << r.config << "] ";
+    if (!base) {
+      out << "no baseline\n";
+      continue;
+    }
+
+    bool cpuRegressed =
+        isRegression(r.cpuMeanMs, base->cpuMeanMs, tolerance, minDeltaMs);
+    bool gpuRegressed =
+        isRegression(r.gpuMeanMs, base->gpuMeanMs, tolerance, minDeltaMs);
+    out << "cpu " << base->cpuMeanMs << " -> " << r.cpuMeanMs << " ms ("
+        << std::showpos << percentChange(r.cpuMeanMs, base->cpuMeanMs)
+        << std::noshowpos << "%), gpu " << base->gpuMeanMs << " -> "
+        << r.gpuMeanMs << " ms (" << std::showpos
+        << percentChange(r.gpuMeanMs, base->gpuMeanMs) << std::noshowpos
+        << "%)";
+    if (cpuRegressed || gpuRegressed) {
+      out << "  REGRESSION";
+      regressions++;
+    }
+    out << "\n";
+  }
+
+  // Rows that disappeared mean the sweep itself changed
+  for (size_t j = 0; j < baseline.size(); j++) {
+    bool found = false;
+    for (size_t i = 0; i < results.size() && !found; i++)
+      found = results[i].demo == baseline[j].demo &&
+              results[i].config == baseline[j].config;
+    if (!found)
+      out << baseline[j].demo << " [" << baseline[j].config
+          << "] missing from this run\n";
+  }
+
+  out.flush();
+  return regressions;
+}
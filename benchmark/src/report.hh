@@ -0,0 +1,31 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+// One configuration of a sweep. The config string is a space-separated list
+// of key=value pairs and, together with the demo name, identifies the row
+// when a report is compared with a baseline.
+struct BenchmarkResult {
+  std::string demo;
+  std::string config;
+  int frames;
+  double cpuMeanMs;
+  double cpuP95Ms;
+  double gpuMeanMs;
+  double gpuP95Ms;
+};
+
+// Reports are CSV with a header line and one row per configuration, in sweep
+// order, so two runs can also be compared with a plain diff
+void writeReport(std::ostream &out, const std::vector<BenchmarkResult> &results);
+bool writeReport(const char *path, const std::vector<BenchmarkResult> &results);
+bool readReport(const char *path, std::vector<BenchmarkResult> &results);
+
+// Prints every configuration against its baseline row and returns how many
+// regressed: a mean CPU or GPU time more than tolerance (a fraction) above
+// the baseline and by at least minDeltaMs, which keeps sub-timer noise on
+// trivial configurations from failing the comparison
+int compareReports(const std::vector<BenchmarkResult> &results,
+                   const std::vector<BenchmarkResult> &baseline,
+                   double tolerance, double minDeltaMs, std::ostream &out);
@@ -0,0 +1,160 @@
+#include "render_state.hh"
+#include <cstring>
+
+UniformBuffer::UniformBuffer(size_t size)
+    : buffer(0), data(size, 0), dirtyBegin(0), dirtyEnd(size) {}
+
+UniformBuffer::~UniformBuffer() { cleanup(); }
+
+bool UniformBuffer::initialize() {
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferData(GL_UNIFORM_BUFFER, data.size(), data.data(), GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  dirtyBegin = dirtyEnd = 0;
+  return buffer != 0;
+}
+
+void UniformBuffer::cleanup() {
+  if (buffer) {
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+  }
+  // Everything has to be sent again if the buffer is recreated
+  dirtyBegin = 0;
+  dirtyEnd = data.size();
+}
+
+void UniformBuffer::write(size_t offset, const void *src, size_t size) {
+  if (offset + size > data.size() || !std::memcmp(&data[offset], src, size))
+    return;
+
+  std::memcpy(&data[offset], src, size);
+  if (dirtyBegin == dirtyEnd) {
+    dirtyBegin = offset;
+    dirtyEnd = offset + size;
+  } else {
+    if (offset < dirtyBegin)
+      dirtyBegin = offset;
+    if (offset + size > dirtyEnd)
+      dirtyEnd = offset + size;
+  }
+}
+
+bool UniformBuffer::isDirty() const { return dirtyBegin != dirtyEnd; }
+
+void UniformBuffer::upload() {
+  if (!buffer || !isDirty())
+    return;
+
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, dirtyBegin, dirtyEnd - dirtyBegin,
+                  &data[dirtyBegin]);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  dirtyBegin = dirtyEnd = 0;
+}
+
+GLuint UniformBuffer::getBuffer() const { return buffer; }
+
+RenderState::RenderState() { invalidate(); }
+
+void RenderState::useProgram(GLuint value) {
+  if (value == program)
+    return;
+  glUseProgram(value);
+  program = value;
+}
+
+void RenderState::bindVertexArray(GLuint value) {
+  if (value == vertexArray)
+    return;
+  glBindVertexArray(value);
+  vertexArray = value;
+}
+
+void RenderState::bindUniformBuffer(GLuint binding, GLuint buffer) {
+  // A size of -1 marks a whole-buffer binding
+  if (blockBuffers[binding] == buffer && blockSizes[binding] == -1)
+    return;
+  glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+  blockBuffers[binding] = buffer;
+  blockOffsets[binding] = 0;
+  blockSizes[binding] = -1;
+}
+
+void RenderState::bindUniformBufferRange(GLuint binding, GLuint buffer,
+                                         GLintptr offset, GLsizeiptr size) {
+  if (blockBuffers[binding] == buffer && blockOffsets[binding] == offset &&
+      blockSizes[binding] == size)
+    return;
+  glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+  blockBuffers[binding] = buffer;
+  blockOffsets[binding] = offset;
+  blockSizes[binding] = size;
+}
+
+void RenderState::invalidate() {
+  // Object name ~0u is never handed out, so the next bind always goes through
+  program = ~0u;
+  vertexArray = ~0u;
+  for (int i = 0; i < MAX_BLOCK_BINDINGS; i++) {
+    blockBuffers[i] = ~0u;
+    blockOffsets[i] = 0;
+    blockSizes[i] = 0;
+  }
+}
+
+void RenderState::draw(const DrawCommand &command) {
+  useProgram(command.program);
+  for (int binding = 0; binding < MAX_BLOCK_BINDINGS; binding++) {
+    if (UniformBuffer *block = command.blocks[binding]) {
+      block->upload();
+      bindUniformBuffer(binding, block->getBuffer());
+    } else if (command.rangeBuffers[binding]) {
+      bindUniformBufferRange(binding, command.rangeBuffers[binding],
+                             command.rangeOffsets[binding],
+                             command.rangeSizes[binding]);
+    }
+  }
+  bindVertexArray(command.vertexArray);
+
+  if (command.indexType) {
+    const void *indices = 0;
+    if (command.instanceCount > 1)
+      glDrawElementsInstanced(command.mode, command.count, command.indexType,
+                              indices, command.instanceCount);
+    else
+      glDrawElements(command.mode, command.count, command.indexType, indices);
+  } else {
+    if (command.instanceCount > 1)
+      glDrawArraysInstanced(command.mode, command.first, command.count,
+                            command.instanceCount);
+    else
+      glDrawArrays(command.mode, command.first, command.count);
+  }
+}
+
+DrawCommand makeDrawCommand(GLuint program, GLuint vertexArray, GLenum mode,
+                            GLsizei count) {
+  DrawCommand command;
+  command.program = program;
+  command.vertexArray = vertexArray;
+  for (int i = 0; i < MAX_BLOCK_BINDINGS; i++) {
+    command.blocks[i] = NULL;
+    command.rangeBuffers[i] = 0;
+    command.rangeOffsets[i] = 0;
+    command.rangeSizes[i] = 0;
+  }
+  command.mode = mode;
+  command.first = 0;
+  command.count = count;
+  command.indexType = 0;
+  command.instanceCount = 1;
+  return command;
+}
+
+void bindUniformBlock(GLuint program, const char *name, GLuint binding) {
+  GLuint index = glGetUniformBlockIndex(program, name);
+  if (index != GL_INVALID_INDEX)
+    glUniformBlockBinding(program, index, binding);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+// Uniform block binding points shared by the shaders of both demos
+#define FRAME_BLOCK_BINDING 0
+#define MATERIAL_BLOCK_BINDING 1
+#define INSTANCE_BLOCK_BINDING 2
+#define MAX_BLOCK_BINDINGS 3
+
+// Per-frame data, std140 layout of the FrameData block
+struct FrameData {
+  float projection[16];
+  float view[16];
+  float time;
+  float padding[3];
+};
+
+// CPU copy of a std140 uniform block. Writes that actually change the
+// contents widen a dirty byte range, and upload() sends only that range.
+class UniformBuffer {
+private:
+  GLuint buffer;
+  std::vector<unsigned char> data;
+  size_t dirtyBegin, dirtyEnd;
+
+public:
+  explicit UniformBuffer(size_t size);
+  ~UniformBuffer();
+
+  bool initialize();
+  void cleanup();
+
+  void write(size_t offset, const void *src, size_t size);
+  template <typename T> void set(size_t offset, const T &value) {
+    write(offset, &value, sizeof(T));
+  }
+
+  bool isDirty() const;
+  void upload();
+  GLuint getBuffer() const;
+};
+
+struct DrawCommand;
+
+// Last bound GL objects, so that redundant binds never reach the driver.
+// Anything bound behind its back must be followed by invalidate().
+class RenderState {
+private:
+  GLuint program;
+  GLuint vertexArray;
+  GLuint blockBuffers[MAX_BLOCK_BINDINGS];
+  GLintptr blockOffsets[MAX_BLOCK_BINDINGS];
+  GLsizeiptr blockSizes[MAX_BLOCK_BINDINGS];
+
+public:
+  RenderState();
+
+  void useProgram(GLuint value);
+  void bindVertexArray(GLuint value);
+  void bindUniformBuffer(GLuint binding, GLuint buffer);
+  void bindUniformBufferRange(GLuint binding, GLuint buffer, GLintptr offset,
+                              GLsizeiptr size);
+  void invalidate();
+
+  // Binds what the command needs, uploading dirty blocks first, and draws
+  void draw(const DrawCommand &command);
+};
+
+// One draw and the state it needs. indexType is 0 for glDrawArrays.
+// A binding takes either a whole UniformBuffer or a range of a raw buffer;
+// with neither set it is left alone.
+struct DrawCommand {
+  GLuint program;
+  GLuint vertexArray;
+  UniformBuffer *blocks[MAX_BLOCK_BINDINGS];
+  GLuint rangeBuffers[MAX_BLOCK_BINDINGS];
+  GLintptr rangeOffsets[MAX_BLOCK_BINDINGS];
+  GLsizeiptr rangeSizes[MAX_BLOCK_BINDINGS];
+  GLenum mode;
+  GLint first;
+  GLsizei count;
+  GLenum indexType;
+  GLsizei instanceCount;
+};
+
+DrawCommand makeDrawCommand(GLuint program, GLuint vertexArray, GLenum mode,
+                            GLsizei count);
+
+// Attaches a named uniform block to a binding point, if the program uses it
+void bindUniformBlock(GLuint program, const char *name, GLuint binding);
@@ -0,0 +1,58 @@
+#version 330 core
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in float inLife;        // life / maxLife, unorm16
+layout(location = 2) in float inInitialSize; // half float
+layout(location = 3) in float inTemperature; // unorm16
+
+// Must match FrameData in common/render_state.hh (std140)
+layout(std140) uniform FrameData {
+    mat4 u_projection;
+    mat4 u_view;
+    float u_time;
+};
+
+// Point size in pixels of a unit-size particle at the camera
+uniform float u_sprite_scale;
+
+out vec4 fragColor;
+out float particleSize;
+
+// Mirrors getSpawnColor and getParticleColor in particle.cpp
+vec4 fireColor(float lifeRatio, float temperature) {
+    if (lifeRatio >= 1.0) {
+        // Spawned this frame
+        return vec4(1.0, 0.3 + temperature * 0.7,
+                    temperature > 0.9 ? 0.2 : 0.0, 1.0);
+    }
+
+    vec3 rgb;
+    if (lifeRatio > 0.7) {
+        rgb = vec3(1.0, 0.8 + temperature * 0.2, temperature > 0.8 ? 0.4 : 0.0);
+    } else if (lifeRatio > 0.4) {
+        float t = (lifeRatio - 0.4) / 0.3;
+        rgb = vec3(1.0, 0.4 + t * 0.4, t * 0.1);
+    } else if (lifeRatio > 0.2) {
+        float t = (lifeRatio - 0.2) / 0.2;
+        rgb = vec3(0.8 + t * 0.2, t * 0.3, 0.0);
+    } else {
+        float fadeRatio = lifeRatio / 0.2;
+        rgb = vec3(0.3, 0.1, 0.1) * fadeRatio;
+    }
+
+    float a = lifeRatio < 0.3 ? lifeRatio / 0.3 : 1.0;
+    return vec4(rgb, a * 0.8);
+}
+
+void main() {
+    gl_Position = u_projection * u_view * vec4(inPos, 1.0);
+
+    // Size grows as the particle rises and cools
+    float size = inInitialSize * (1.0 + (1.0 - inLife) * 2.0);
+
+    float distance = length((u_view * vec4(inPos, 1.0)).xyz);
+    gl_PointSize = size * u_sprite_scale / (1.0 + distance * 0.1);
+
+    fragColor = fireColor(inLife, inTemperature);
+    particleSize = size;
+}
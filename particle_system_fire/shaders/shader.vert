@@ -4,18 +4,25 @@ layout(location = 0) in vec3 inPos;
 layout(location = 1) in float inSize;
 layout(location = 2) in vec4 inColor;
 
-uniform mat4 projection;
-uniform mat4 view;
+// Must match FrameData in common/render_state.hh (std140)
+layout(std140) uniform FrameData {
+    mat4 u_projection;
+    mat4 u_view;
+    float u_time;
+};
+
+// Point size in pixels of a unit-size particle at the camera
+uniform float u_sprite_scale;
 
 out vec4 fragColor;
 out float particleSize;
 
 void main() {
-    gl_Position = projection * view * vec4(inPos, 1.0);
+    gl_Position = u_projection * u_view * vec4(inPos, 1.0);
 
     // Dynamic point size based on distance and particle properties
-    float distance = length((view * vec4(inPos, 1.0)).xyz);
-    gl_PointSize = inSize * 150.0 / (1.0 + distance * 0.1);
+    float distance = length((u_view * vec4(inPos, 1.0)).xyz);
+    gl_PointSize = inSize * u_sprite_scale / (1.0 + distance * 0.1);
 
     fragColor = inColor;
     particleSize = inSize;
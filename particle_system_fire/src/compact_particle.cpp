@@ -0,0 +1,154 @@
+#include "compact_particle.hh"
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+
+CompactParticle compactParticle(const Particle &p) {
+  CompactParticle c;
+  c.position = p.position;
+  c.life = glm::packUnorm1x16(p.life / p.maxLife);
+  c.initialSize = glm::packHalf1x16(p.initialSize);
+  c.temperature = glm::packUnorm1x16(p.temperature);
+  c.maxLife = glm::packHalf1x16(p.maxLife);
+  c.turbulence = glm::packUnorm1x16(p.turbulence);
+  for (int i = 0; i < 3; i++)
+    c.velocity[i] = glm::packHalf1x16(p.velocity[i]);
+  return c;
+}
+
+Particle expandParticle(const CompactParticle &c, bool active) {
+  Particle p;
+  p.position = c.position;
+  for (int i = 0; i < 3; i++)
+    p.velocity[i] = glm::unpackHalf1x16(c.velocity[i]);
+  p.acceleration = glm::vec3(0.0f);
+  p.maxLife = glm::unpackHalf1x16(c.maxLife);
+  p.life = glm::unpackUnorm1x16(c.life) * p.maxLife;
+  p.initialSize = glm::unpackHalf1x16(c.initialSize);
+  p.temperature = glm::unpackUnorm1x16(c.temperature);
+  p.turbulence = glm::unpackUnorm1x16(c.turbulence);
+  getCompactVisuals(c, p.size, p.color);
+  p.active = active;
+  return p;
+}
+
+static bool isActive(const CompactParticles &store, size_t index) {
+  return (store.active[index / 32] >> (index % 32)) & 1u;
+}
+
+static void setActive(CompactParticles &store, size_t index, bool active) {
+  uint32_t bit = 1u << (index % 32);
+  if (active)
+    store.active[index / 32] |= bit;
+  else
+    store.active[index / 32] &= ~bit;
+}
+
+void initCompactParticles(CompactParticles &store, size_t count) {
+  store.particles.resize(count);
+  store.active.assign((count + 31) / 32, 0u);
+  for (size_t i = 0; i < count; i++) {
+    Particle p;
+    initParticle(p);
+    store.particles[i] = compactParticle(p);
+    setActive(store, i, p.active);
+  }
+}
+
+void updateCompactParticle(CompactParticles &store, size_t index, float dt) {
+  // Same simulation as the full path, on a temporary full-precision copy
+  Particle p = expandParticle(store.particles[index], isActive(store, index));
+  updateParticle(p, dt);
+  store.particles[index] = compactParticle(p);
+  setActive(store, index, p.active);
+}
+
+void updateCompactParticles(CompactParticles &store, float dt) {
+  for (size_t i = 0; i < store.particles.size(); i++)
+    updateCompactParticle(store, i, dt);
+}
+
+void getCompactVisuals(const CompactParticle &c, float &size,
+                       glm::vec4 &color) {
+  float lifeRatio = glm::unpackUnorm1x16(c.life);
+  float temperature = glm::unpackUnorm1x16(c.temperature);
+  float initialSize = glm::unpackHalf1x16(c.initialSize);
+
+  // A full-scale life marks a particle spawned this frame
+  size = initialSize * (1.0f + (1.0f - lifeRatio) * 2.0f);
+  color = c.life == 0xffff ? getSpawnColor(temperature)
+                           : getParticleColor(lifeRatio, temperature);
+}
+
+CompactComparison compareCompactParticles(unsigned int seed, size_t count,
+                                          int frames, float dt) {
+  CompactComparison result = {0.0f, 0.0f, 0.0f, 0.0f, 0, 0, 0};
+  double squaredColorError = 0.0;
+
+  seedParticles(seed);
+  std::vector<Particle> particles(count);
+  CompactParticles store;
+  store.particles.resize(count);
+  store.active.assign((count + 31) / 32, 0u);
+  for (size_t i = 0; i < count; i++) {
+    initParticle(particles[i]);
+    store.particles[i] = compactParticle(particles[i]);
+    setActive(store, i, particles[i].active);
+  }
+
+  for (int frame = 0; frame < frames; frame++) {
+    for (size_t i = 0; i < count; i++) {
+      Particle &p = particles[i];
+
+      // Both paths draw from the same RNG state, so a respawn on both sides
+      // produces the same particle
+      EmitterState before = getEmitterState();
+      bool fullRespawn = !p.active || p.life <= 0.0f;
+      updateParticle(p, dt);
+      EmitterState after = getEmitterState();
+
+      setEmitterState(before);
+      Particle expanded =
+          expandParticle(store.particles[i], isActive(store, i));
+      bool compactRespawn = !expanded.active || expanded.life <= 0.0f;
+      updateCompactParticle(store, i, dt);
+      setEmitterState(after);
+
+      if (fullRespawn != compactRespawn) {
+        result.respawnMismatches++;
+        store.particles[i] = compactParticle(p);
+        setActive(store, i, p.active);
+        continue;
+      }
+
+      float size;
+      glm::vec4 color;
+      getCompactVisuals(store.particles[i], size, color);
+
+      float positionError =
+          glm::length(store.particles[i].position - p.position);
+      float sizeError = std::fabs(size - p.size);
+      // Compared as stored in the framebuffer, which clamps to [0, 1]
+      float colorError = 0.0f;
+      for (int c = 0; c < 4; c++) {
+        float drawn = glm::clamp(color[c], 0.0f, 1.0f);
+        float expected = glm::clamp(p.color[c], 0.0f, 1.0f);
+        float error = std::fabs(drawn - expected);
+        colorError = std::fmax(colorError, error);
+        squaredColorError += error * error;
+      }
+      if (colorError > COMPACT_COLOR_TOLERANCE)
+        result.colorOutliers++;
+
+      result.maxPositionError =
+          std::fmax(result.maxPositionError, positionError);
+      result.maxSizeError = std::fmax(result.maxSizeError, sizeError);
+      result.maxColorError = std::fmax(result.maxColorError, colorError);
+      result.samples++;
+    }
+  }
+
+  if (result.samples)
+    result.rmsColorError =
+        static_cast<float>(std::sqrt(squaredColorError / (result.samples * 4)));
+  return result;
+}
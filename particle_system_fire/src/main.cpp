@@ -3,16 +3,108 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "compact_particle.hh"
 #include "particle.hh"
+#include "render_state.hh"
 #include "shader.hh"
+#include "snapshot.hh"
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <iostream>
 #include <vector>
 
 #define PARTICLE_COUNT 5000 // Increased for denser fire
+#define SPRITE_SCALE 150.0f
+
+void printUsage() {
+  std::cout << "Usage: FireParticle [options]\n"
+            << "  --record <file>          Capture every simulated frame\n"
+            << "  --replay <file>          Play a capture back instead of "
+               "simulating\n"
+            << "  --seed <n>               Fix the emitter RNG\n"
+            << "  --compact                Simulate with quantized particles\n"
+            << "  --compare-compact <n>    Check quantized against full "
+               "precision over n frames"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Options are listed in printUsage; anything else is an error
+  const char *recordPath = nullptr;
+  const char *replayPath = nullptr;
+  unsigned int seed = (unsigned)time(0);
+  bool compact = false;
+  int compareFrames = 0;
+  for (int i = 1; i < argc; i++) {
+    bool takesValue = !strcmp(argv[i], "--record") ||
+                      !strcmp(argv[i], "--replay") ||
+                      !strcmp(argv[i], "--seed") ||
+                      !strcmp(argv[i], "--compare-compact");
+    if (!strcmp(argv[i], "--help")) {
+      printUsage();
+      return 0;
+    } else if (!strcmp(argv[i], "--compact")) {
+      compact = true;
+    } else if (!takesValue) {
+      std::cerr << "Unknown option " << argv[i] << std::endl;
+      printUsage();
+      return -1;
+    } else if (i + 1 >= argc) {
+      std::cerr << "Missing value for " << argv[i] << std::endl;
+      printUsage();
+      return -1;
+    } else if (!strcmp(argv[i], "--record")) {
+      recordPath = argv[++i];
+    } else if (!strcmp(argv[i], "--replay")) {
+      replayPath = argv[++i];
+    } else if (!strcmp(argv[i], "--seed")) {
+      seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+    } else {
+      compareFrames = atoi(argv[++i]);
+    }
+  }
+
+  if (compareFrames > 0) {
+    CompactComparison result = compareCompactParticles(
+        seed, PARTICLE_COUNT, compareFrames, 1.0f / 60.0f);
+    float outliers =
+        float(result.colorOutliers + result.respawnMismatches) /
+        float(result.samples + result.respawnMismatches);
+    std::cout << "Compact vs full, " << result.samples << " samples:"
+              << "\n  max position error: " << result.maxPositionError
+              << "\n  max size error: " << result.maxSizeError
+              << "\n  max color error: " << result.maxColorError
+              << "\n  rms color error: " << result.rmsColorError
+              << "\n  color outliers: " << result.colorOutliers
+              << "\n  respawn mismatches: " << result.respawnMismatches
+              << std::endl;
+    bool pass = result.rmsColorError <= COMPACT_COLOR_TOLERANCE &&
+                result.maxPositionError < 0.01f && outliers < 0.01f;
+    std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+  }
+
+  if (compact && (recordPath || replayPath)) {
+    std::cerr << "Snapshots store full-precision particles only" << std::endl;
+    return -1;
+  }
+  seedParticles(seed);
+
+  SnapshotReader replay;
+  size_t particleCount = PARTICLE_COUNT;
+  if (replayPath) {
+    if (!replay.open(replayPath) || replay.getFrameCount() == 0) {
+      std::cerr << "Nothing to replay in " << replayPath << std::endl;
+      return -1;
+    }
+    particleCount = replay.getParticleCount();
+  }
+
+  SnapshotWriter recorder;
+  if (recordPath && !replayPath && !recorder.open(recordPath, particleCount))
+    return -1;
 
-int main() {
-  srand((unsigned)time(0));
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -23,28 +115,60 @@ int main() {
   glewExperimental = GL_TRUE;
   glewInit();
 
-  GLuint shader = createProgram("shaders/shader.vert", "shaders/shader.frag");
+  GLuint shader = createProgram(
+      compact ? "shaders/compact.vert" : "shaders/shader.vert",
+      "shaders/shader.frag");
+  bindUniformBlock(shader, "FrameData", FRAME_BLOCK_BINDING);
+  glUseProgram(shader);
+  glUniform1f(glGetUniformLocation(shader, "u_sprite_scale"), SPRITE_SCALE);
+
+  RenderState state;
+  UniformBuffer frameBlock(sizeof(FrameData));
+  frameBlock.initialize();
 
-  std::vector<Particle> particles(PARTICLE_COUNT);
+  std::vector<Particle> particles((replayPath || compact) ? 0 : particleCount);
   for (auto &p : particles)
     initParticle(p);
 
+  CompactParticles compactStore;
+  if (compact)
+    initCompactParticles(compactStore, particleCount);
+
   GLuint vao, vbo;
   glGenVertexArrays(1, &vao);
   glGenBuffers(1, &vbo);
   glBindVertexArray(vao);
   glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), nullptr,
-               GL_DYNAMIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)0);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Particle),
-                        (void *)(offsetof(Particle, size)));
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle),
-                        (void *)(offsetof(Particle, color)));
-  glEnableVertexAttribArray(2);
+  if (compact) {
+    GLsizei stride = sizeof(CompactParticle);
+    glBufferData(GL_ARRAY_BUFFER, particleCount * stride, nullptr,
+                 GL_DYNAMIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                          (void *)(offsetof(CompactParticle, life)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 1, GL_HALF_FLOAT, GL_FALSE, stride,
+                          (void *)(offsetof(CompactParticle, initialSize)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                          (void *)(offsetof(CompactParticle, temperature)));
+    glEnableVertexAttribArray(3);
+  } else {
+    glBufferData(GL_ARRAY_BUFFER, particleCount * sizeof(Particle), nullptr,
+                 GL_DYNAMIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle),
+                          (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Particle),
+                          (void *)(offsetof(Particle, size)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle),
+                          (void *)(offsetof(Particle, color)));
+    glEnableVertexAttribArray(2);
+  }
 
   // Enhanced blending for more realistic fire
   glEnable(GL_BLEND);
@@ -57,6 +181,7 @@ int main() {
   glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0, -0.5f, -4));
 
   double lastTime = glfwGetTime();
+  size_t replayFrame = 0;
 
   while (!glfwWindowShouldClose(win)) {
     double currentTime = glfwGetTime();
@@ -66,25 +191,52 @@ int main() {
     glfwPollEvents();
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Update particles with actual delta time for smooth animation
-    for (auto &p : particles)
-      updateParticle(p, deltaTime);
-
-    glBufferSubData(GL_ARRAY_BUFFER, 0, particles.size() * sizeof(Particle),
-                    particles.data());
-
-    glUseProgram(shader);
-    glUniformMatrix4fv(glGetUniformLocation(shader, "projection"), 1, GL_FALSE,
-                       &projection[0][0]);
-    glUniformMatrix4fv(glGetUniformLocation(shader, "view"), 1, GL_FALSE,
-                       &view[0][0]);
-
-    glBindVertexArray(vao);
-    glDrawArrays(GL_POINTS, 0, PARTICLE_COUNT);
+    if (replayPath) {
+      // Straight from the mapped file into the buffer, no staging copy
+      glBufferSubData(GL_ARRAY_BUFFER, 0, particleCount * sizeof(Particle),
+                      replay.getParticles(replayFrame));
+      replayFrame = (replayFrame + 1) % replay.getFrameCount();
+    } else if (compact) {
+      updateCompactParticles(compactStore, deltaTime);
+
+      glBufferSubData(GL_ARRAY_BUFFER, 0,
+                      particleCount * sizeof(CompactParticle),
+                      compactStore.particles.data());
+    } else {
+      // Update particles with actual delta time for smooth animation
+      for (auto &p : particles)
+        updateParticle(p, deltaTime);
+
+      glBufferSubData(GL_ARRAY_BUFFER, 0, particles.size() * sizeof(Particle),
+                      particles.data());
+
+      // A failed write (e.g. a full disk) ends the recording, the frames
+      // written so far stay replayable
+      if (recordPath &&
+          !recorder.writeFrame(deltaTime, getEmitterState(), particles)) {
+        std::cerr << "Recording stopped after a write error" << std::endl;
+        recorder.close();
+        recordPath = nullptr;
+      }
+    }
+
+    // Unchanged matrices compare equal and are not re-sent
+    frameBlock.write(offsetof(FrameData, projection), &projection[0][0],
+                     sizeof(FrameData::projection));
+    frameBlock.write(offsetof(FrameData, view), &view[0][0],
+                     sizeof(FrameData::view));
+
+    DrawCommand draw =
+        makeDrawCommand(shader, vao, GL_POINTS, (GLsizei)particleCount);
+    draw.blocks[FRAME_BLOCK_BINDING] = &frameBlock;
+    state.draw(draw);
 
     glfwSwapBuffers(win);
   }
 
+  recorder.close();
+  replay.close();
+  frameBlock.cleanup();
   glDeleteBuffers(1, &vbo);
   glDeleteVertexArrays(1, &vao);
   glfwDestroyWindow(win);
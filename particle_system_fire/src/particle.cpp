@@ -1,41 +1,101 @@
 #include "particle.hh"
 #include <cmath>
-#include <cstdlib>
+
+// Everything outside the particles that the simulation depends on; kept
+// together so snapshots can capture and restore it
+static EmitterState emitter = {2463534242u, 0.0f};
+
+// xorshift32 in place of rand(), whose state cannot be saved
+static int nextRandom() {
+  unsigned int x = emitter.rngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  emitter.rngState = x;
+  return static_cast<int>(x >> 1);
+}
+
+void seedParticles(unsigned int seed) {
+  emitter.rngState = seed ? seed : 2463534242u; // Zero is a fixed point
+  emitter.globalTime = 0.0f;
+}
+
+EmitterState getEmitterState() { return emitter; }
+
+void setEmitterState(const EmitterState &state) { emitter = state; }
 
 void initParticle(Particle &p) {
   p.active = true;
-  p.maxLife = 0.5f + (rand() % 100) / 100.0f * 1.0f; // 1.5-3.5 seconds
+  p.maxLife = 0.5f + (nextRandom() % 100) / 100.0f * 1.0f; // 1.5-3.5 seconds
   p.life = p.maxLife;
 
   // Start from base of fire with slight spread
   float baseSpread = 2.0f;
-  p.position = glm::vec3(((rand() % 100) / 100.0f - 0.5f) * baseSpread,
-                         -1.3f + (rand() % 100) /
+  p.position = glm::vec3(((nextRandom() % 100) / 100.0f - 0.5f) * baseSpread,
+                         -1.3f + (nextRandom() % 100) /
                                      500.0f, // Slight height variation at base
-                         ((rand() % 100) / 100.0f - 0.5f) * baseSpread);
+                         ((nextRandom() % 100) / 100.0f - 0.5f) * baseSpread);
 
   // Initial upward velocity with randomness
-  float upwardForce = 1.2f + (rand() % 100) / 200.0f;
+  float upwardForce = 1.2f + (nextRandom() % 100) / 200.0f;
   p.velocity =
-      glm::vec3(((rand() % 100) / 100.0f - 0.5f) * 0.3f, // Horizontal spread
+      glm::vec3(((nextRandom() % 100) / 100.0f - 0.5f) * 0.3f, // Horizontal spread
                 upwardForce,                             // Strong upward motion
-                ((rand() % 100) / 100.0f - 0.5f) * 0.3f);
+                ((nextRandom() % 100) / 100.0f - 0.5f) * 0.3f);
 
   p.acceleration = glm::vec3(0.0f, -0.5f, 0.0f); // Gravity + buoyancy
 
-  p.initialSize = 0.08f + (rand() % 100) / 1000.0f;
+  p.initialSize = 0.08f + (nextRandom() % 100) / 1000.0f;
   p.size = p.initialSize;
 
   // Temperature affects initial color (hotter = more white/yellow)
-  p.temperature = 0.8f + (rand() % 100) / 500.0f;
+  p.temperature = 0.8f + (nextRandom() % 100) / 500.0f;
 
   // Start with hot colors
+  p.color = getSpawnColor(p.temperature);
+
+  p.turbulence = (nextRandom() % 100) / 100.0f;
+}
+
+glm::vec4 getSpawnColor(float temperature) {
   float r = 1.0f;
-  float g = 0.3f + p.temperature * 0.7f;
-  float b = p.temperature > 0.9f ? 0.2f : 0.0f;
-  p.color = glm::vec4(r, g, b, 1.0f);
+  float g = 0.3f + temperature * 0.7f;
+  float b = temperature > 0.9f ? 0.2f : 0.0f;
+  return glm::vec4(r, g, b, 1.0f);
+}
+
+glm::vec4 getParticleColor(float lifeRatio, float temperature) {
+  // Color transition: White/Yellow -> Orange -> Red -> Dark Red -> Transparent
+  float r, g, b, a;
+
+  if (lifeRatio > 0.7f) {
+    // Hot phase: white/yellow
+    r = 1.0f;
+    g = 0.8f + temperature * 0.2f;
+    b = temperature > 0.8f ? 0.4f : 0.0f;
+  } else if (lifeRatio > 0.4f) {
+    // Orange phase
+    r = 1.0f;
+    g = 0.4f + (lifeRatio - 0.4f) / 0.3f * 0.4f;
+    b = (lifeRatio - 0.4f) / 0.3f * 0.1f;
+  } else if (lifeRatio > 0.2f) {
+    // Red phase
+    r = 0.8f + (lifeRatio - 0.2f) / 0.2f * 0.2f;
+    g = (lifeRatio - 0.2f) / 0.2f * 0.3f;
+    b = 0.0f;
+  } else {
+    // Dark red/smoke phase
+    float fadeRatio = lifeRatio / 0.2f;
+    r = 0.3f * fadeRatio;
+    g = 0.1f * fadeRatio;
+    b = 0.1f * fadeRatio;
+  }
+
+  // Alpha fades out at the end
+  a = lifeRatio < 0.3f ? lifeRatio / 0.3f : 1.0f;
+  a *= 0.8f; // Overall transparency for blending
 
-  p.turbulence = (rand() % 100) / 100.0f;
+  return glm::vec4(r, g, b, a);
 }
 
 glm::vec3 getWindForce(const glm::vec3 &pos, float time) {
@@ -57,8 +117,8 @@ void updateParticle(Particle &p, float dt) {
   float lifeRatio = p.life / p.maxLife;
 
   // Apply wind and turbulence
-  static float globalTime = 0.0f;
-  globalTime += dt;
+  emitter.globalTime += dt;
+  float globalTime = emitter.globalTime;
 
   glm::vec3 windForce = getWindForce(p.position, globalTime);
   glm::vec3 turbulenceForce =
@@ -78,35 +138,5 @@ void updateParticle(Particle &p, float dt) {
   // Temperature decreases over time
   p.temperature = lifeRatio * 0.9f + 0.1f;
 
-  // Color transition: White/Yellow -> Orange -> Red -> Dark Red -> Transparent
-  float r, g, b, a;
-
-  if (lifeRatio > 0.7f) {
-    // Hot phase: white/yellow
-    r = 1.0f;
-    g = 0.8f + p.temperature * 0.2f;
-    b = p.temperature > 0.8f ? 0.4f : 0.0f;
-  } else if (lifeRatio > 0.4f) {
-    // Orange phase
-    r = 1.0f;
-    g = 0.4f + (lifeRatio - 0.4f) / 0.3f * 0.4f;
-    b = (lifeRatio - 0.4f) / 0.3f * 0.1f;
-  } else if (lifeRatio > 0.2f) {
-    // Red phase
-    r = 0.8f + (lifeRatio - 0.2f) / 0.2f * 0.2f;
-    g = (lifeRatio - 0.2f) / 0.2f * 0.3f;
-    b = 0.0f;
-  } else {
-    // Dark red/smoke phase
-    float fadeRatio = lifeRatio / 0.2f;
-    r = 0.3f * fadeRatio;
-    g = 0.1f * fadeRatio;
-    b = 0.1f * fadeRatio;
-  }
-
-  // Alpha fades out at the end
-  a = lifeRatio < 0.3f ? lifeRatio / 0.3f : 1.0f;
-  a *= 0.8f; // Overall transparency for blending
-
-  p.color = glm::vec4(r, g, b, a);
+  p.color = getParticleColor(lifeRatio, p.temperature);
 }
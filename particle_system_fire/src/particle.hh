@@ -15,6 +15,17 @@ struct Particle {
   bool active;
 };
 
+struct EmitterState {
+  unsigned int rngState;
+  float globalTime;
+};
+
+void seedParticles(unsigned int seed);
+EmitterState getEmitterState();
+void setEmitterState(const EmitterState &state);
+
 void initParticle(Particle &p);
 void updateParticle(Particle &p, float dt);
 glm::vec3 getWindForce(const glm::vec3 &pos, float time);
+glm::vec4 getSpawnColor(float temperature);
+glm::vec4 getParticleColor(float lifeRatio, float temperature);
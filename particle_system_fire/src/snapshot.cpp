@@ -0,0 +1,158 @@
+#include "snapshot.hh"
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint64_t alignTo16(uint64_t size) { return (size + 15) & ~uint64_t(15); }
+
+SnapshotWriter::SnapshotWriter() { std::memset(&header, 0, sizeof(header)); }
+
+SnapshotWriter::~SnapshotWriter() { close(); }
+
+bool SnapshotWriter::open(const char *path, size_t particleCount) {
+  file.open(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::cerr << "Snapshot open error: " << path << std::endl;
+    return false;
+  }
+
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.particleSize = sizeof(Particle);
+  header.particleCount = static_cast<uint32_t>(particleCount);
+  header.frameStride =
+      alignTo16(sizeof(SnapshotFrame) + particleCount * sizeof(Particle));
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  return static_cast<bool>(file);
+}
+
+bool SnapshotWriter::writeFrame(float deltaTime, const EmitterState &emitter,
+                                const std::vector<Particle> &particles) {
+  if (!file.is_open() || particles.size() != header.particleCount)
+    return false;
+
+  SnapshotFrame frame;
+  std::memset(&frame, 0, sizeof(frame));
+  frame.deltaTime = deltaTime;
+  frame.emitter = emitter;
+  file.write(reinterpret_cast<const char *>(&frame), sizeof(frame));
+  file.write(reinterpret_cast<const char *>(particles.data()),
+             particles.size() * sizeof(Particle));
+
+  static const char zeros[16] = {0};
+  size_t used = sizeof(frame) + particles.size() * sizeof(Particle);
+  file.write(zeros, header.frameStride - used);
+
+  if (!file) {
+    std::cerr << "Snapshot write error" << std::endl;
+    return false;
+  }
+  header.frameCount++;
+  return true;
+}
+
+void SnapshotWriter::close() {
+  if (!file.is_open())
+    return;
+  // Rewriting the header needs no new space, so try even after a failed write
+  file.clear();
+  file.seekp(0);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.close();
+}
+
+SnapshotReader::SnapshotReader()
+    : mapping(MAP_FAILED), mappingSize(0), header(nullptr), frameCount(0) {}
+
+SnapshotReader::~SnapshotReader() { close(); }
+
+bool SnapshotReader::open(const char *path) {
+  close();
+
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Snapshot open error: " << path << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+    std::cerr << "Snapshot too small: " << path << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  mappingSize = static_cast<size_t>(info.st_size);
+  mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "Snapshot map error: " << path << std::endl;
+    return false;
+  }
+
+  header = static_cast<const SnapshotHeader *>(mapping);
+  uint64_t expectedStride = alignTo16(
+      sizeof(SnapshotFrame) + uint64_t(header->particleCount) * sizeof(Particle));
+  const char *error = nullptr;
+  if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)))
+    error = "not a snapshot";
+  else if (header->version != SNAPSHOT_VERSION)
+    error = "unsupported version";
+  else if (header->particleSize != sizeof(Particle) ||
+           header->frameStride != expectedStride)
+    error = "particle layout mismatch";
+  else if (sizeof(SnapshotHeader) + header->frameCount * header->frameStride >
+           mappingSize)
+    error = "truncated file";
+
+  // A recording that was killed before close() still has every complete
+  // frame on disk, only the count in the header is missing
+  frameCount = header->frameCount;
+  if (!error && frameCount == 0)
+    frameCount = (mappingSize - sizeof(SnapshotHeader)) / header->frameStride;
+
+  if (error) {
+    std::cerr << "Snapshot error (" << error << "): " << path << std::endl;
+    close();
+    return false;
+  }
+
+  // Frames are read front to back during replay
+  madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+  return true;
+}
+
+void SnapshotReader::close() {
+  if (mapping != MAP_FAILED) {
+    munmap(mapping, mappingSize);
+    mapping = MAP_FAILED;
+  }
+  mappingSize = 0;
+  header = nullptr;
+  frameCount = 0;
+}
+
+size_t SnapshotReader::getFrameCount() const {
+  return frameCount;
+}
+
+size_t SnapshotReader::getParticleCount() const {
+  return header ? header->particleCount : 0;
+}
+
+const SnapshotFrame &SnapshotReader::getFrame(size_t index) const {
+  const char *base = static_cast<const char *>(mapping);
+  return *reinterpret_cast<const SnapshotFrame *>(
+      base + sizeof(SnapshotHeader) + index * header->frameStride);
+}
+
+const Particle *SnapshotReader::getParticles(size_t index) const {
+  const char *frame = reinterpret_cast<const char *>(&getFrame(index));
+  return reinterpret_cast<const Particle *>(frame + sizeof(SnapshotFrame));
+}
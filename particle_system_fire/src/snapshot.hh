@@ -0,0 +1,65 @@
+#pragma once
+#include "particle.hh"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Snapshot file layout (native endianness, every block 16-byte aligned):
+//   SnapshotHeader
+//   frameCount x { SnapshotFrame, particleCount x Particle }
+// Frames have a fixed stride, so a mapped file can be indexed directly and
+// its particle arrays handed to glBufferSubData without any copy.
+#define SNAPSHOT_MAGIC "FIRESNAP"
+#define SNAPSHOT_VERSION 1
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t particleSize; // sizeof(Particle) of the writer, guards the layout
+  uint32_t particleCount;
+  uint32_t frameCount;    // Patched on close; 0 if the writer never closed
+  uint64_t frameStride;  // Bytes from one SnapshotFrame to the next
+};
+
+struct SnapshotFrame {
+  float deltaTime;
+  EmitterState emitter; // State after this frame's update
+  float padding;
+};
+
+class SnapshotWriter {
+private:
+  std::ofstream file;
+  SnapshotHeader header;
+
+public:
+  SnapshotWriter();
+  ~SnapshotWriter();
+
+  bool open(const char *path, size_t particleCount);
+  bool writeFrame(float deltaTime, const EmitterState &emitter,
+                  const std::vector<Particle> &particles);
+  void close(); // Patches the frame count into the header
+};
+
+class SnapshotReader {
+private:
+  void *mapping;
+  size_t mappingSize;
+  const SnapshotHeader *header;
+  size_t frameCount;
+
+public:
+  SnapshotReader();
+  ~SnapshotReader();
+
+  bool open(const char *path);
+  void close();
+
+  size_t getFrameCount() const;
+  size_t getParticleCount() const;
+  const SnapshotFrame &getFrame(size_t index) const;
+  const Particle *getParticles(size_t index) const; // Points into the mapping
+};
@@ -3,12 +3,34 @@ out vec4 FragColor;
 
 in vec2 TexCoord;
 
-uniform float u_time;
-uniform float u_intensity;
-uniform float u_speed;
-uniform int u_octaves;
-uniform float u_scale;
-uniform int u_noise_type; // 0 = simplex, 1 = perlin
+// Must match FrameData in common/render_state.hh (std140)
+layout (std140) uniform FrameData {
+    mat4 u_projection;
+    mat4 u_view;
+    float u_time;
+};
+
+// Must match FireMaterial in fire_shader.hh (std140)
+layout (std140) uniform FireMaterial {
+    float u_intensity;
+    float u_speed;
+    float u_scale;
+    int u_octaves;
+    int u_noise_type; // 0 = simplex, 1 = perlin
+};
+
+#ifdef INSTANCED
+// Per-instance parameters from fire_instanced_vertex.glsl
+flat in vec4 v_params;     // intensity, speed, scale, seed
+flat in int v_octaves;
+#endif
+
+// Multi-rate octave evaluation
+uniform int u_octave_mode;          // 0 = full, 1 = cache pass, 2 = cached
+uniform int u_coarse_octaves;       // Octaves of the first layer taken from the cache
+uniform sampler2D u_octave_cache;   // (noise1, noise2, noise3, motion) coarse terms
+uniform float u_cache_time;         // u_time the cache is evaluated at
+uniform float u_cache_margin;       // Extra UV coverage of the cache on each side
 
 // Hash function for noise generation
 vec3 hash3(vec2 p) {
@@ -93,13 +115,14 @@ float noise2D(vec2 p) {
     }
 }
 
-// Fractal Brownian Motion
-float fbm(vec2 p, int octaves) {
+// Fractal Brownian Motion over octaves [first, last)
+float fbmRange(vec2 p, int first, int last) {
+    first = max(first, 0);
     float value = 0.0;
-    float amplitude = 0.5;
-    float frequency = 1.0;
+    float amplitude = 0.5 * exp2(-float(first));
+    float frequency = exp2(float(first));
     
-    for (int i = 0; i < octaves; i++) {
+    for (int i = first; i < last; i++) {
         value += amplitude * noise2D(p * frequency);
         frequency *= 2.0;
         amplitude *= 0.5;
@@ -108,13 +131,14 @@ float fbm(vec2 p, int octaves) {
     return value;
 }
 
-// Turbulence function
-float turbulence(vec2 p, int octaves) {
+// Turbulence over octaves [first, last)
+float turbulenceRange(vec2 p, int first, int last) {
+    first = max(first, 0);
     float value = 0.0;
-    float amplitude = 0.5;
-    float frequency = 1.0;
+    float amplitude = 0.5 * exp2(-float(first));
+    float frequency = exp2(float(first));
     
-    for (int i = 0; i < octaves; i++) {
+    for (int i = first; i < last; i++) {
         value += amplitude * abs(noise2D(p * frequency));
         frequency *= 2.0;
         amplitude *= 0.5;
@@ -123,6 +147,34 @@ float turbulence(vec2 p, int octaves) {
     return value;
 }
 
+// Fractal Brownian Motion
+float fbm(vec2 p, int octaves) {
+    return fbmRange(p, 0, octaves);
+}
+
+// Turbulence function
+float turbulence(vec2 p, int octaves) {
+    return turbulenceRange(p, 0, octaves);
+}
+
+// Octaves [first, last) of the three fire layers. Each layer starts at twice
+// the frequency of the previous one and so has one octave fewer.
+vec3 layerNoise(vec2 p, float time, int first, int last) {
+    return vec3(
+        fbmRange(p + vec2(0.0, time * 0.5), first, last),
+        fbmRange(p * 2.0 + vec2(time * 0.3, time * 0.8), first - 1, last - 1),
+        turbulenceRange(p * 4.0 + vec2(time * 0.1, time * 1.2), first - 2, last - 2));
+}
+
+float flameMotion(vec2 uv, float time) {
+    return fbm(vec2(uv.x * 3.0, uv.y * 2.0 + time * 1.5), 3);
+}
+
+// Cache lookup in flipped UV space, covering [-margin, 1 + margin]
+vec4 cachedLayers(vec2 uv) {
+    return texture(u_octave_cache,
+                   (uv + u_cache_margin) / (1.0 + 2.0 * u_cache_margin));
+}
 
 // Fire color ramp
 vec3 fireColor(float t) {
@@ -157,22 +209,58 @@ void main()
     // Flip vertical uv so flames rise upward
     uv.y = 1.0 - uv.y;
 
-    float time = u_time * u_speed;
-    vec2 p = uv * u_scale;
+#ifdef INSTANCED
+    float intensity = v_params.x;
+    float speed = v_params.y;
+    float scale = v_params.z;
+    int octaves = v_octaves;
+    float localTime = u_time + v_params.w; // Seed shifts the animation phase
+#else
+    float intensity = u_intensity;
+    float speed = u_speed;
+    float scale = u_scale;
+    int octaves = u_octaves;
+    // The cache pass evaluates at the cache's own time, not the frame's
+    float localTime = (u_octave_mode == 1) ? u_cache_time : u_time;
+#endif
 
-    float noise1 = fbm(p + vec2(0.0, time * 0.5), u_octaves);
-    float noise2 = fbm(p * 2.0 + vec2(time * 0.3, time * 0.8), u_octaves - 1);
-    float noise3 = turbulence(p * 4.0 + vec2(time * 0.1, time * 1.2), u_octaves - 2);
-    
-    float firenoise = noise1 * 0.5 + noise2 * 0.3 + noise3 * 0.2;
+    float time = localTime * speed;
+    int coarse = min(u_coarse_octaves, octaves);
+
+    if (u_octave_mode == 1) {
+        // Cache pass: store the coarse terms over the margin-extended domain
+        vec2 cacheUV = mix(vec2(-u_cache_margin), vec2(1.0 + u_cache_margin),
+                           TexCoord);
+        FragColor = vec4(layerNoise(cacheUV * scale, time, 0, coarse),
+                         flameMotion(cacheUV, time));
+        return;
+    }
+
+    vec2 p = uv * scale;
+    vec3 layers;
+    float flamemotion;
+
+    if (u_octave_mode == 2) {
+        // Every layer is a pure translation in time, so the stale cache is
+        // read back exactly by shifting each lookup by the elapsed offset
+        float dt = (localTime - u_cache_time) * speed;
+        layers = vec3(cachedLayers(uv + vec2(0.0, 0.5) * dt / scale).x,
+                      cachedLayers(uv + vec2(0.3, 0.8) * dt / (2.0 * scale)).y,
+                      cachedLayers(uv + vec2(0.1, 1.2) * dt / (4.0 * scale)).z);
+        layers += layerNoise(p, time, coarse, octaves);
+        flamemotion = cachedLayers(uv + vec2(0.0, 0.75 * dt)).w;
+    } else {
+        layers = layerNoise(p, time, 0, octaves);
+        flamemotion = flameMotion(uv, time);
+    }
 
-    float flamemotion = fbm(vec2(uv.x * 3.0, uv.y * 2.0 + time * 1.5), 3);
+    float firenoise = layers.x * 0.5 + layers.y * 0.3 + layers.z * 0.2;
     firenoise += flamemotion * 0.3;
 
     float flamemask = uv.y * uv.y; // Stronger at bottom
     flamemask *= smoothstep(0.0, 0.3, 1.0 - abs(uv.x - 0.5) * 2.0);
 
-    float fireintensity = (firenoise + 0.5) * flamemask * u_intensity;
+    float fireintensity = (firenoise + 0.5) * flamemask * intensity;
 
     float flicker = sin(time * 15.0) * 0.1 + sin(time * 23.0) * 0.05;
     fireintensity += flicker * flamemask;
@@ -0,0 +1,34 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// Must match FireInstance in fire_shader.hh (std140)
+struct FireInstance {
+    vec4 bounds;   // center.xy, halfSize.xy in NDC
+    vec4 params;   // intensity, speed, scale, seed
+    ivec4 config;  // octaves, unused
+};
+
+layout (std140) uniform FireInstances {
+    FireInstance instances[MAX_INSTANCES];
+};
+
+uniform vec2 u_jitter; // Sub-pixel offset in NDC, zero unless upsampling
+
+out vec2 TexCoord;
+flat out vec4 v_params;
+flat out int v_octaves;
+
+void main()
+{
+    FireInstance instance = instances[gl_InstanceID];
+
+    // The unit quad is stretched over the flame's screen-space bounds, so
+    // pixels outside every flame are never rasterized
+    vec2 position = instance.bounds.xy + aPos.xy * instance.bounds.zw;
+    gl_Position = vec4(position + u_jitter, aPos.z, 1.0);
+    TexCoord = aTexCoord;
+
+    v_params = instance.params;
+    v_octaves = instance.config.x;
+}
@@ -0,0 +1,59 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D u_current;     // Jittered fire at reduced resolution
+uniform sampler2D u_history;     // Previous resolved frame, output resolution
+uniform vec2 u_current_texel;    // 1.0 / size of the u_current texture
+uniform vec2 u_scene_uv_scale;   // Used sub-rectangle of u_current, in UV
+uniform vec2 u_jitter_offset;    // Jitter of the current frame, scene pixels
+uniform float u_feedback;        // History weight, 0.0 = plain upsample
+uniform int u_unpremultiply;     // 1 = output straight alpha (present pass)
+
+vec4 sampleCurrent(vec2 uv) {
+    // Stay inside the rendered sub-rectangle so bilinear taps never read
+    // stale texels left over from a larger scale
+    vec2 lo = 0.5 * u_current_texel;
+    vec2 hi = u_scene_uv_scale - 0.5 * u_current_texel;
+    return texture(u_current, clamp(uv, lo, hi));
+}
+
+// Inputs are premultiplied; the present pass hands straight alpha to the
+// caller's blend function
+vec4 finish(vec4 color) {
+    if (u_unpremultiply == 0)
+        return color;
+    return color.a > 0.0 ? vec4(color.rgb / color.a, color.a) : vec4(0.0);
+}
+
+void main()
+{
+    // The scene was shifted by the jitter, so the content for this pixel
+    // sits that many scene pixels further along
+    vec2 sceneUV = TexCoord * u_scene_uv_scale
+                 + u_jitter_offset * u_current_texel;
+    vec4 current = sampleCurrent(sceneUV);
+
+    if (u_feedback <= 0.0) {
+        FragColor = finish(current);
+        return;
+    }
+
+    // Neighbourhood clamp keeps the animated flame from ghosting
+    vec4 minColor = current;
+    vec4 maxColor = current;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec4 s = sampleCurrent(sceneUV + vec2(x, y) * u_current_texel);
+            minColor = min(minColor, s);
+            maxColor = max(maxColor, s);
+        }
+    }
+
+    // The quad is static in screen space, so every pixel reprojects onto
+    // itself and the history is read at the same coordinate
+    vec4 history = clamp(texture(u_history, TexCoord), minColor, maxColor);
+
+    FragColor = finish(mix(current, history, u_feedback));
+}
@@ -2,10 +2,12 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
+uniform vec2 u_jitter; // Sub-pixel offset in NDC, zero unless upsampling
+
 out vec2 TexCoord;
 
 void main()
 {
-    gl_Position = vec4(aPos, 1.0);
+    gl_Position = vec4(aPos.xy + u_jitter, aPos.z, 1.0);
     TexCoord = aTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "dynamic_resolution.hh"
+#include <cmath>
+#include <iostream>
+
+// Radical inverse used for the low-discrepancy jitter sequence
+static float halton(unsigned int index, unsigned int base) {
+  float result = 0.0f;
+  float fraction = 1.0f / base;
+  while (index > 0) {
+    result += fraction * (index % base);
+    index /= base;
+    fraction /= base;
+  }
+  return result;
+}
+
+DynamicResolution::DynamicResolution()
+    : sceneFBO(0), sceneTexture(0), outputWidth(0), outputHeight(0),
+      sceneWidth(0), sceneHeight(0), historyIndex(0), historyValid(false),
+      frameIndex(0), renderScale(1.0f), minScale(0.25f), maxScale(1.0f),
+      targetGpuMs(2.0f), lastGpuMs(0.0f) {
+  historyFBO[0] = historyFBO[1] = 0;
+  historyTexture[0] = historyTexture[1] = 0;
+  for (int i = 0; i < QUERY_COUNT; i++) {
+    timerQueries[i] = 0;
+    queryIssued[i] = false;
+    queryScale[i] = 1.0f;
+  }
+}
+
+DynamicResolution::~DynamicResolution() { cleanup(); }
+
+bool DynamicResolution::initialize() {
+  glGenQueries(QUERY_COUNT, timerQueries);
+  return true;
+}
+
+GLuint DynamicResolution::createColorTarget(GLuint &texture, int width,
+                                            int height) {
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  GLuint fbo;
+  glGenFramebuffers(1, &fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Dynamic resolution framebuffer incomplete" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &texture);
+    texture = 0;
+    return 0;
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  return fbo;
+}
+
+void DynamicResolution::releaseTargets() {
+  if (sceneFBO) {
+    glDeleteFramebuffers(1, &sceneFBO);
+    sceneFBO = 0;
+  }
+  if (sceneTexture) {
+    glDeleteTextures(1, &sceneTexture);
+    sceneTexture = 0;
+  }
+  for (int i = 0; i < 2; i++) {
+    if (historyFBO[i]) {
+      glDeleteFramebuffers(1, &historyFBO[i]);
+      historyFBO[i] = 0;
+    }
+    if (historyTexture[i]) {
+      glDeleteTextures(1, &historyTexture[i]);
+      historyTexture[i] = 0;
+    }
+  }
+  outputWidth = outputHeight = 0;
+  historyValid = false;
+}
+
+bool DynamicResolution::resize(int width, int height) {
+  if (width == outputWidth && height == outputHeight && sceneFBO)
+    return true;
+
+  releaseTargets();
+  if (width <= 0 || height <= 0)
+    return false;
+
+  // The scene target is full size; only its used sub-rectangle shrinks
+  sceneFBO = createColorTarget(sceneTexture, width, height);
+  historyFBO[0] = createColorTarget(historyTexture[0], width, height);
+  historyFBO[1] = createColorTarget(historyTexture[1], width, height);
+  if (!sceneFBO || !historyFBO[0] || !historyFBO[1]) {
+    releaseTargets();
+    return false;
+  }
+
+  outputWidth = width;
+  outputHeight = height;
+  return true;
+}
+
+void DynamicResolution::readTimerResults() {
+  int slot = frameIndex % QUERY_COUNT;
+  if (!queryIssued[slot])
+    return;
+
+  // Never stall: if the GPU is further behind than QUERY_COUNT frames the
+  // sample is simply dropped
+  GLint available = 0;
+  glGetQueryObjectiv(timerQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+  queryIssued[slot] = false;
+  if (!available)
+    return;
+
+  GLuint64 elapsed = 0;
+  glGetQueryObjectui64v(timerQueries[slot], GL_QUERY_RESULT, &elapsed);
+  lastGpuMs = static_cast<float>(elapsed) / 1.0e6f;
+  if (lastGpuMs <= 0.0f)
+    return;
+
+  // Shading cost is proportional to pixel count, i.e. to scale squared
+  float desired = queryScale[slot] * std::sqrt(targetGpuMs / lastGpuMs);
+  renderScale += (desired - renderScale) * 0.2f;
+  if (renderScale < minScale)
+    renderScale = minScale;
+  if (renderScale > maxScale)
+    renderScale = maxScale;
+}
+
+void DynamicResolution::beginScene() {
+  frameIndex++;
+  historyIndex = 1 - historyIndex;
+  readTimerResults();
+
+  sceneWidth = static_cast<int>(outputWidth * renderScale + 0.5f);
+  sceneHeight = static_cast<int>(outputHeight * renderScale + 0.5f);
+  if (sceneWidth < 1)
+    sceneWidth = 1;
+  if (sceneHeight < 1)
+    sceneHeight = 1;
+
+  int slot = frameIndex % QUERY_COUNT;
+  queryScale[slot] = renderScale;
+  glBeginQuery(GL_TIME_ELAPSED, timerQueries[slot]);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+  glViewport(0, 0, sceneWidth, sceneHeight);
+
+  // Transparent, so the resolved result can be blended onto the caller's
+  // target; the caller's clear color is left as it was
+  GLfloat clearColor[4];
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+}
+
+void DynamicResolution::endScene() {
+  glEndQuery(GL_TIME_ELAPSED);
+  queryIssued[frameIndex % QUERY_COUNT] = true;
+}
+
+void DynamicResolution::beginResolve() {
+  glBindFramebuffer(GL_FRAMEBUFFER, historyFBO[historyIndex]);
+  glViewport(0, 0, outputWidth, outputHeight);
+}
+
+void DynamicResolution::endResolve() { historyValid = true; }
+
+void DynamicResolution::getJitter(float &x, float &y) const {
+  // 8-sample Halton(2, 3) pattern, centered on the pixel
+  unsigned int index = (frameIndex % 8) + 1;
+  x = halton(index, 2) - 0.5f;
+  y = halton(index, 3) - 0.5f;
+}
+
+void DynamicResolution::invalidateHistory() { historyValid = false; }
+
+bool DynamicResolution::hasHistory() const { return historyValid; }
+
+void DynamicResolution::cleanup() {
+  releaseTargets();
+  if (timerQueries[0]) {
+    glDeleteQueries(QUERY_COUNT, timerQueries);
+    for (int i = 0; i < QUERY_COUNT; i++) {
+      timerQueries[i] = 0;
+      queryIssued[i] = false;
+    }
+  }
+}
+
+GLuint DynamicResolution::getSceneTexture() const { return sceneTexture; }
+
+GLuint DynamicResolution::getHistoryTexture() const {
+  return historyTexture[1 - historyIndex];
+}
+
+GLuint DynamicResolution::getResolvedTexture() const {
+  return historyTexture[historyIndex];
+}
+
+int DynamicResolution::getOutputWidth() const { return outputWidth; }
+
+int DynamicResolution::getOutputHeight() const { return outputHeight; }
+
+int DynamicResolution::getSceneWidth() const { return sceneWidth; }
+
+int DynamicResolution::getSceneHeight() const { return sceneHeight; }
+
+void DynamicResolution::setTargetGpuTime(float ms) { targetGpuMs = ms; }
+
+float DynamicResolution::getTargetGpuTime() const { return targetGpuMs; }
+
+float DynamicResolution::getLastGpuTime() const { return lastGpuMs; }
+
+void DynamicResolution::setScaleRange(float minValue, float maxValue) {
+  minScale = minValue;
+  maxScale = maxValue;
+  if (renderScale < minScale)
+    renderScale = minScale;
+  if (renderScale > maxScale)
+    renderScale = maxScale;
+}
+
+float DynamicResolution::getRenderScale() const { return renderScale; }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Render targets and GPU-time controller for drawing the fire at a reduced
+// resolution. The scene is shaded into the lower-left sub-rectangle of a
+// full-size texture so that changing the scale never reallocates anything;
+// a full-resolution history (ping-ponged) accumulates the jittered frames.
+class DynamicResolution {
+private:
+  static const int QUERY_COUNT = 3; // Frames in flight before reading back
+
+  GLuint sceneFBO, sceneTexture;
+  GLuint historyFBO[2], historyTexture[2];
+  GLuint timerQueries[QUERY_COUNT];
+  bool queryIssued[QUERY_COUNT];
+  float queryScale[QUERY_COUNT]; // Scale each timed frame was rendered at
+
+  int outputWidth, outputHeight;
+  int sceneWidth, sceneHeight;
+  int historyIndex; // History slot written this frame
+  bool historyValid;
+  unsigned int frameIndex;
+
+  float renderScale;   // Fraction of the output resolution per axis
+  float minScale, maxScale;
+  float targetGpuMs;   // Budget for the scene pass
+  float lastGpuMs;
+
+  GLuint createColorTarget(GLuint &texture, int width, int height);
+  void releaseTargets();
+  void readTimerResults();
+
+public:
+  DynamicResolution();
+  ~DynamicResolution();
+
+  bool initialize();
+  void cleanup();
+
+  // Allocates targets for the given output size; returns false on failure
+  bool resize(int width, int height);
+
+  // Scene pass: binds the scaled target, cleared to transparent black, and
+  // times the work in between
+  void beginScene();
+  void endScene();
+
+  // Resolve pass: binds the history slot written this frame; the caller
+  // rebinds its own target afterwards
+  void beginResolve();
+  void endResolve();
+
+  // Sub-pixel offset in scene pixels for this frame, in [-0.5, 0.5]
+  void getJitter(float &x, float &y) const;
+
+  void invalidateHistory();
+  bool hasHistory() const;
+
+  GLuint getSceneTexture() const;
+  GLuint getHistoryTexture() const;       // Previous frame's result
+  GLuint getResolvedTexture() const;      // Result written this frame
+  int getOutputWidth() const;
+  int getOutputHeight() const;
+  int getSceneWidth() const;
+  int getSceneHeight() const;
+
+  void setTargetGpuTime(float ms);
+  float getTargetGpuTime() const;
+  float getLastGpuTime() const;
+  void setScaleRange(float minValue, float maxValue);
+  float getRenderScale() const;
+};
@@ -1,11 +1,22 @@
 #include "fire_shader.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 FireShader::FireShader()
-    : shaderProgram(0), VAO(0), VBO(0), EBO(0), intensity(1.5f), speed(1.0f),
-      octaves(6), scale(3.0f), noise_type(0) {}
+    : shaderProgram(0), VAO(0), VBO(0), EBO(0), noise_type(0),
+      dynamicResolution(false), temporalFeedback(0.85f), resolveProgram(0),
+      multiRateOctaves(false), coarseOctaves(3), octaveMode(-1),
+      uploadedCoarseOctaves(-1), instancedProgram(0),
+      instanceUBO(0), instanceCapacity(0), instanced(false),
+      frameBlock(sizeof(FrameData)), materialBlock(sizeof(FireMaterial)),
+      intensity(1.5f), speed(1.0f), octaves(6), scale(3.0f) {
+  updateMaterial();
+}
 
 FireShader::~FireShader() { cleanup(); }
 
@@ -28,6 +39,15 @@ std::string loadShaderFromFile(const char* filePath) {
     return shaderCode;
 }
 
+// Injects preprocessor defines right after the #version line
+static void insertDefines(std::string &code, const std::string &defines) {
+  if (defines.empty())
+    return;
+  size_t lineEnd = code.find('\n');
+  code.insert(lineEnd == std::string::npos ? code.size() : lineEnd + 1,
+              defines);
+}
+
 bool FireShader::compileShader(GLuint shader, const char *source,
                                const char *type) {
   glShaderSource(shader, 1, &source, NULL);
@@ -44,14 +64,14 @@ bool FireShader::compileShader(GLuint shader, const char *source,
   return true;
 }
 
-bool FireShader::linkProgram() {
-  glLinkProgram(shaderProgram);
+bool FireShader::linkProgram(GLuint program) {
+  glLinkProgram(program);
 
   int success;
   char infoLog[512];
-  glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
   if (!success) {
-    glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
     std::cerr << "Shader program linking failed: " << infoLog << std::endl;
     return false;
   }
@@ -59,12 +79,39 @@ bool FireShader::linkProgram() {
 }
 
 void FireShader::getUniformLocations() {
-  u_time_loc = glGetUniformLocation(shaderProgram, "u_time");
-  u_intensity_loc = glGetUniformLocation(shaderProgram, "u_intensity");
-  u_speed_loc = glGetUniformLocation(shaderProgram, "u_speed");
-  u_octaves_loc = glGetUniformLocation(shaderProgram, "u_octaves");
-  u_scale_loc = glGetUniformLocation(shaderProgram, "u_scale");
-  u_noise_type_loc = glGetUniformLocation(shaderProgram, "u_noise_type");
+  u_jitter_loc = glGetUniformLocation(shaderProgram, "u_jitter");
+  u_octave_mode_loc = glGetUniformLocation(shaderProgram, "u_octave_mode");
+  u_coarse_octaves_loc =
+      glGetUniformLocation(shaderProgram, "u_coarse_octaves");
+  u_octave_cache_loc = glGetUniformLocation(shaderProgram, "u_octave_cache");
+  u_cache_time_loc = glGetUniformLocation(shaderProgram, "u_cache_time");
+  u_cache_margin_loc = glGetUniformLocation(shaderProgram, "u_cache_margin");
+
+  i_jitter_loc = glGetUniformLocation(instancedProgram, "u_jitter");
+
+  r_current_loc = glGetUniformLocation(resolveProgram, "u_current");
+  r_history_loc = glGetUniformLocation(resolveProgram, "u_history");
+  r_current_texel_loc = glGetUniformLocation(resolveProgram, "u_current_texel");
+  r_scene_uv_scale_loc =
+      glGetUniformLocation(resolveProgram, "u_scene_uv_scale");
+  r_jitter_offset_loc = glGetUniformLocation(resolveProgram, "u_jitter_offset");
+  r_feedback_loc = glGetUniformLocation(resolveProgram, "u_feedback");
+  r_unpremultiply_loc =
+      glGetUniformLocation(resolveProgram, "u_unpremultiply");
+
+  bindUniformBlock(shaderProgram, "FrameData", FRAME_BLOCK_BINDING);
+  bindUniformBlock(shaderProgram, "FireMaterial", MATERIAL_BLOCK_BINDING);
+  bindUniformBlock(instancedProgram, "FrameData", FRAME_BLOCK_BINDING);
+  bindUniformBlock(instancedProgram, "FireMaterial", MATERIAL_BLOCK_BINDING);
+  bindUniformBlock(instancedProgram, "FireInstances", INSTANCE_BLOCK_BINDING);
+
+  // Sampler units and the cache margin never change, so set them once
+  state.useProgram(shaderProgram);
+  glUniform1i(u_octave_cache_loc, 2);
+  glUniform1f(u_cache_margin_loc, octaveCache.getMargin());
+  state.useProgram(resolveProgram);
+  glUniform1i(r_current_loc, 0);
+  glUniform1i(r_history_loc, 1);
 }
 
 void FireShader::setupGeometry() {
@@ -80,7 +127,7 @@ void FireShader::setupGeometry() {
   glGenBuffers(1, &VBO);
   glGenBuffers(1, &EBO);
 
-  glBindVertexArray(VAO);
+  state.bindVertexArray(VAO);
 
   glBindBuffer(GL_ARRAY_BUFFER, VBO);
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -99,11 +146,15 @@ void FireShader::setupGeometry() {
   glEnableVertexAttribArray(1);
 }
 
-bool FireShader::initialize() {
+GLuint FireShader::buildProgram(const char *vertexPath,
+                                const char *fragmentPath,
+                                const std::string &defines) {
   // Load shaders from files
-  std::string vertexCode = loadShaderFromFile("shaders/fire_vertex.glsl");
-  std::string fragmentCode = loadShaderFromFile("shaders/fire_fragment.glsl");
-  
+  std::string vertexCode = loadShaderFromFile(vertexPath);
+  std::string fragmentCode = loadShaderFromFile(fragmentPath);
+  insertDefines(vertexCode, defines);
+  insertDefines(fragmentCode, defines);
+
   const char* vertexShaderSource = vertexCode.c_str();
   const char* fragmentShaderSource = fragmentCode.c_str();
 
@@ -111,7 +162,7 @@ bool FireShader::initialize() {
   GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
   if (!compileShader(vertexShader, vertexShaderSource, "Vertex")) {
     glDeleteShader(vertexShader);
-    return false;
+    return 0;
   }
 
   // Create and compile fragment shader
@@ -119,25 +170,55 @@ bool FireShader::initialize() {
   if (!compileShader(fragmentShader, fragmentShaderSource, "Fragment")) {
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
-    return false;
+    return 0;
   }
 
   // Create shader program
-  shaderProgram = glCreateProgram();
-  glAttachShader(shaderProgram, vertexShader);
-  glAttachShader(shaderProgram, fragmentShader);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
 
-  if (!linkProgram()) {
+  if (!linkProgram(program)) {
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
-    glDeleteProgram(shaderProgram);
-    return false;
+    glDeleteProgram(program);
+    return 0;
   }
 
   // Clean up shaders
   glDeleteShader(vertexShader);
   glDeleteShader(fragmentShader);
 
+  return program;
+}
+
+bool FireShader::initialize() {
+  shaderProgram =
+      buildProgram("shaders/fire_vertex.glsl", "shaders/fire_fragment.glsl");
+  if (!shaderProgram)
+    return false;
+
+  resolveProgram = buildProgram("shaders/fire_vertex.glsl",
+                                "shaders/fire_upsample_fragment.glsl");
+  if (!resolveProgram)
+    return false;
+
+  std::string instancedDefines =
+      "#define INSTANCED\n#define MAX_INSTANCES " +
+      std::to_string(MAX_FIRE_INSTANCES) + "\n";
+  instancedProgram =
+      buildProgram("shaders/fire_instanced_vertex.glsl",
+                   "shaders/fire_fragment.glsl", instancedDefines);
+  if (!instancedProgram)
+    return false;
+
+  if (!dynamicRes.initialize())
+    return false;
+
+  glGenBuffers(1, &instanceUBO);
+  if (!frameBlock.initialize() || !materialBlock.initialize())
+    return false;
+
   // Get uniform locations and setup geometry
   getUniformLocations();
   setupGeometry();
@@ -145,27 +226,406 @@ bool FireShader::initialize() {
   return true;
 }
 
-void FireShader::render(float currentTime) {
-  glUseProgram(shaderProgram);
+void FireShader::updateMaterial() {
+  // Field by field, so only the parameters that changed are re-sent
+  materialBlock.set(offsetof(FireMaterial, intensity), intensity);
+  materialBlock.set(offsetof(FireMaterial, speed), speed);
+  materialBlock.set(offsetof(FireMaterial, scale), scale);
+  materialBlock.set(offsetof(FireMaterial, octaves), octaves);
+  materialBlock.set(offsetof(FireMaterial, noiseType), noise_type);
+}
+
+void FireShader::setFrameTime(float currentTime) {
+  frameBlock.set(offsetof(FrameData, time), currentTime);
+}
 
-  // Update uniforms
-  glUniform1f(u_time_loc, currentTime);
-  glUniform1f(u_intensity_loc, intensity);
-  glUniform1f(u_speed_loc, speed);
-  glUniform1i(u_octaves_loc, octaves);
-  glUniform1f(u_scale_loc, scale);
-  glUniform1i(u_noise_type_loc, noise_type);
+void FireShader::setOctaveMode(int mode) {
+  // Uniforms keep their values in the program, so only changes are sent;
+  // expects shaderProgram to be current
+  if (mode != octaveMode) {
+    glUniform1i(u_octave_mode_loc, mode);
+    octaveMode = mode;
+  }
+  if (mode != 0 && coarseOctaves != uploadedCoarseOctaves) {
+    glUniform1i(u_coarse_octaves_loc, coarseOctaves);
+    uploadedCoarseOctaves = coarseOctaves;
+  }
+}
+
+DrawCommand FireShader::quadCommand(GLuint program) {
+  DrawCommand command = makeDrawCommand(program, VAO, GL_TRIANGLES, 6);
+  command.indexType = GL_UNSIGNED_INT;
+  command.blocks[FRAME_BLOCK_BINDING] = &frameBlock;
+  command.blocks[MATERIAL_BLOCK_BINDING] = &materialBlock;
+  return command;
+}
+
+void FireShader::drawFire(float currentTime) {
+  state.useProgram(shaderProgram);
+  setFrameTime(currentTime);
+
+  // The cache ages in frames, not time; after a hitch or at low frame rates
+  // the reprojected lookups leave its margin, so evaluate in full and
+  // rebuild instead. The per-unit-time offsets match fire_fragment.glsl,
+  // flame motion at 0.75 and the first noise layer at 0.5 / scale.
+  if (multiRateOctaves && octaveCache.isValid()) {
+    float reach = std::max(0.75f, 0.5f / scale) * speed;
+    float age = std::fabs(currentTime - octaveCache.getCacheTime());
+    if (age * reach > octaveCache.getMargin())
+      octaveCache.invalidate();
+  }
+
+  if (multiRateOctaves && octaveCache.isValid()) {
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, octaveCache.getTexture());
+    glActiveTexture(GL_TEXTURE0);
+    setOctaveMode(2);
+    glUniform1f(u_cache_time_loc, octaveCache.getCacheTime());
+  } else {
+    setOctaveMode(0);
+  }
 
   // Render quad
-  glBindVertexArray(VAO);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  state.draw(quadCommand(shaderProgram));
+}
+
+void FireShader::drawInstances(float currentTime) {
+  if (instances.empty())
+    return;
+
+  setFrameTime(currentTime);
+
+  // Each batch binds a block-sized window of the buffer; the window size
+  // (MAX_FIRE_INSTANCES * 48 bytes) is a multiple of any offset alignment
+  const GLsizeiptr batchBytes = MAX_FIRE_INSTANCES * sizeof(FireInstance);
+  for (size_t first = 0; first < instances.size();
+       first += MAX_FIRE_INSTANCES) {
+    size_t count = instances.size() - first;
+    if (count > MAX_FIRE_INSTANCES)
+      count = MAX_FIRE_INSTANCES;
+    DrawCommand command = quadCommand(instancedProgram);
+    command.rangeBuffers[INSTANCE_BLOCK_BINDING] = instanceUBO;
+    command.rangeOffsets[INSTANCE_BLOCK_BINDING] = first * sizeof(FireInstance);
+    command.rangeSizes[INSTANCE_BLOCK_BINDING] = batchBytes;
+    command.instanceCount = static_cast<GLsizei>(count);
+    state.draw(command);
+  }
+}
+
+void FireShader::drawScene(float currentTime) {
+  if (instanced)
+    drawInstances(currentTime);
+  else
+    drawFire(currentTime);
+}
+
+void FireShader::setJitter(float x, float y) {
+  state.useProgram(shaderProgram);
+  glUniform2f(u_jitter_loc, x, y);
+  state.useProgram(instancedProgram);
+  glUniform2f(i_jitter_loc, x, y);
+}
+
+void FireShader::updateOctaveCache(float currentTime) {
+  // The cache is sized from, and restores, the caller's target
+  GLint viewport[4];
+  GLint previousFBO;
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+  if (!octaveCache.resize(viewport[2], viewport[3])) {
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+    return;
+  }
+
+  GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+  glDisable(GL_BLEND);
+
+  state.useProgram(shaderProgram);
+  setOctaveMode(1);
+
+  for (int pending = octaveCache.pendingBands(); pending > 0; pending--) {
+    octaveCache.beginBand(currentTime);
+    glUniform1f(u_cache_time_loc, octaveCache.getBuildTime());
+    state.draw(quadCommand(shaderProgram));
+    octaveCache.endBand();
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  if (blendEnabled)
+    glEnable(GL_BLEND);
+}
+
+void FireShader::drawResolve(GLuint current, GLuint history, float feedback) {
+  state.useProgram(resolveProgram);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, current);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, history);
+  glActiveTexture(GL_TEXTURE0);
+
+  glUniform1f(r_feedback_loc, feedback);
+
+  DrawCommand command = makeDrawCommand(resolveProgram, VAO, GL_TRIANGLES, 6);
+  command.indexType = GL_UNSIGNED_INT;
+  state.draw(command);
+}
+
+void FireShader::renderScaled(float currentTime) {
+  // Output size comes from whatever viewport the caller set up, and the
+  // result is presented to whatever framebuffer it had bound
+  GLint viewport[4];
+  GLint previousFBO;
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+  if (!dynamicRes.resize(viewport[2], viewport[3])) {
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+    drawScene(currentTime);
+    return;
+  }
+
+  // The scaled target holds premultiplied color with coverage in alpha,
+  // which is what blending over transparent black with a separate alpha
+  // factor produces; it upsamples and accumulates without fringes
+  GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+  GLint blendFunc[4];
+  glGetIntegerv(GL_BLEND_SRC_RGB, &blendFunc[0]);
+  glGetIntegerv(GL_BLEND_DST_RGB, &blendFunc[1]);
+  glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendFunc[2]);
+  glGetIntegerv(GL_BLEND_DST_ALPHA, &blendFunc[3]);
+  glEnable(GL_BLEND);
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                      GL_ONE_MINUS_SRC_ALPHA);
+
+  // Scene pass: jittered fire into the scaled sub-rectangle
+  dynamicRes.beginScene();
+  float jitterX, jitterY;
+  dynamicRes.getJitter(jitterX, jitterY);
+  setJitter(jitterX * 2.0f / dynamicRes.getSceneWidth(),
+            jitterY * 2.0f / dynamicRes.getSceneHeight());
+  drawScene(currentTime);
+  setJitter(0.0f, 0.0f);
+  dynamicRes.endScene();
+  glDisable(GL_BLEND);
+
+  // Resolve pass: upsample and accumulate into the history
+  float width = static_cast<float>(dynamicRes.getOutputWidth());
+  float height = static_cast<float>(dynamicRes.getOutputHeight());
+  dynamicRes.beginResolve();
+  state.useProgram(resolveProgram);
+  glUniform2f(r_current_texel_loc, 1.0f / width, 1.0f / height);
+  glUniform2f(r_scene_uv_scale_loc, dynamicRes.getSceneWidth() / width,
+              dynamicRes.getSceneHeight() / height);
+  glUniform2f(r_jitter_offset_loc, jitterX, jitterY);
+  drawResolve(dynamicRes.getSceneTexture(), dynamicRes.getHistoryTexture(),
+              dynamicRes.hasHistory() ? temporalFeedback : 0.0f);
+  dynamicRes.endResolve();
+
+  // Present: a zero-feedback resolve of the full-size result is a plain copy,
+  // which also works when the default framebuffer is multisampled. It goes
+  // back to straight alpha and blends with the caller's own state, as the
+  // fire would if drawn there directly.
+  glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  glBlendFuncSeparate(blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]);
+  if (blendEnabled)
+    glEnable(GL_BLEND);
+  glUniform2f(r_scene_uv_scale_loc, 1.0f, 1.0f);
+  glUniform2f(r_jitter_offset_loc, 0.0f, 0.0f);
+  glUniform1i(r_unpremultiply_loc, 1);
+  drawResolve(dynamicRes.getResolvedTexture(), dynamicRes.getHistoryTexture(),
+              0.0f);
+  glUniform1i(r_unpremultiply_loc, 0);
+}
+
+void FireShader::render(float currentTime) {
+  // The octave cache covers the single full-screen fire only
+  if (multiRateOctaves && !instanced)
+    updateOctaveCache(currentTime);
+
+  if (dynamicResolution)
+    renderScaled(currentTime);
+  else
+    drawScene(currentTime);
 }
 
 void FireShader::toggleNoiseType() {
   noise_type = 1 - noise_type; // Toggle between 0 and 1
+  updateMaterial();
+  octaveCache.invalidate();
+}
+
+void FireShader::setNoiseType(int type) {
+  noise_type = type;
+  updateMaterial();
+  octaveCache.invalidate();
+}
+
+void FireShader::setDynamicResolution(bool enabled) {
+  if (enabled && !dynamicResolution)
+    dynamicRes.invalidateHistory();
+  dynamicResolution = enabled;
+}
+
+void FireShader::toggleDynamicResolution() {
+  setDynamicResolution(!dynamicResolution);
+}
+
+void FireShader::setTargetGpuTime(float ms) { dynamicRes.setTargetGpuTime(ms); }
+
+void FireShader::setMultiRateOctaves(bool enabled) {
+  if (enabled && !multiRateOctaves)
+    octaveCache.invalidate();
+  multiRateOctaves = enabled;
+}
+
+void FireShader::toggleMultiRateOctaves() {
+  setMultiRateOctaves(!multiRateOctaves);
+}
+
+void FireShader::setCoarseOctaves(int value) {
+  coarseOctaves = value;
+  octaveCache.invalidate();
+}
+
+void FireShader::setOctaveRefreshFrames(int frames) {
+  octaveCache.setRefreshFrames(frames);
+}
+
+void FireShader::setInstances(const std::vector<FireInstance> &fires) {
+  instances = fires;
+
+  // Round the storage up to whole batches so every bound window is full
+  size_t batches =
+      (instances.size() + MAX_FIRE_INSTANCES - 1) / MAX_FIRE_INSTANCES;
+  size_t capacity = batches * MAX_FIRE_INSTANCES;
+
+  glBindBuffer(GL_UNIFORM_BUFFER, instanceUBO);
+  if (capacity > instanceCapacity) {
+    glBufferData(GL_UNIFORM_BUFFER, capacity * sizeof(FireInstance), NULL,
+                 GL_DYNAMIC_DRAW);
+    instanceCapacity = capacity;
+  }
+  if (!instances.empty())
+    glBufferSubData(GL_UNIFORM_BUFFER, 0,
+                    instances.size() * sizeof(FireInstance),
+                    instances.data());
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FireShader::setInstanced(bool enabled) {
+  // The octave cache is not refreshed while instanced, so it is stale by
+  // the time the single fire comes back
+  if (enabled != instanced) {
+    dynamicRes.invalidateHistory();
+    octaveCache.invalidate();
+  }
+  instanced = enabled;
+}
+
+void FireShader::toggleInstanced() { setInstanced(!instanced); }
+
+OctaveCacheReport FireShader::compareOctaveCache(float startTime, int frames) {
+  OctaveCacheReport report = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+  GLint viewport[4];
+  GLint previousFBO;
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+  int width = viewport[2];
+  int height = viewport[3];
+  if (width <= 0 || height <= 0 || frames <= 0)
+    return report;
+
+  GLuint texture, fbo, query;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, NULL);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glGenFramebuffers(1, &fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  glViewport(0, 0, width, height);
+  glGenQueries(1, &query);
+
+  std::vector<unsigned char> fullPixels(width * height * 4);
+  std::vector<unsigned char> cachedPixels(width * height * 4);
+  double fullNs = 0.0, cachedNs = 0.0, squaredError = 0.0;
+  int maxError = 0;
+
+  bool wasMultiRate = multiRateOctaves;
+  multiRateOctaves = true;
+  octaveCache.invalidate();
+  updateOctaveCache(startTime - 1.0f / 60.0f); // Prime outside the timings
+
+  for (int frame = 0; frame < frames; frame++) {
+    float time = startTime + frame / 60.0f;
+    GLuint64 elapsed = 0;
+
+    // Full evaluation
+    multiRateOctaves = false;
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    drawFire(time);
+    glEndQuery(GL_TIME_ELAPSED);
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    fullNs += static_cast<double>(elapsed);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                 fullPixels.data());
+
+    // Cached evaluation, including this frame's share of the refresh
+    multiRateOctaves = true;
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    updateOctaveCache(time);
+    drawFire(time);
+    glEndQuery(GL_TIME_ELAPSED);
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    cachedNs += static_cast<double>(elapsed);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                 cachedPixels.data());
+
+    for (size_t i = 0; i < fullPixels.size(); i++) {
+      if (i % 4 == 3)
+        continue; // Alpha only gates blending, already folded into RGB
+      int diff = std::abs(fullPixels[i] - cachedPixels[i]);
+      squaredError += diff * diff;
+      if (diff > maxError)
+        maxError = diff;
+    }
+  }
+
+  multiRateOctaves = wasMultiRate;
+  octaveCache.invalidate();
+
+  glDeleteQueries(1, &query);
+  glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+  glDeleteFramebuffers(1, &fbo);
+  glDeleteTextures(1, &texture);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+  double samples = static_cast<double>(width) * height * 3 * frames;
+  report.fullGpuMs = static_cast<float>(fullNs / frames / 1.0e6);
+  report.cachedGpuMs = static_cast<float>(cachedNs / frames / 1.0e6);
+  report.rmse = static_cast<float>(std::sqrt(squaredError / samples) / 255.0);
+  report.maxError = maxError / 255.0f;
+  report.psnr = report.rmse > 0.0f ? -20.0f * std::log10(report.rmse)
+                                   : INFINITY;
+  return report;
 }
 
 void FireShader::cleanup() {
+  octaveCache.cleanup();
+  dynamicRes.cleanup();
+  frameBlock.cleanup();
+  materialBlock.cleanup();
+  state.invalidate();
+  octaveMode = -1;
+  uploadedCoarseOctaves = -1;
   if (VAO) {
     glDeleteVertexArrays(1, &VAO);
     VAO = 0;
@@ -182,16 +642,44 @@ void FireShader::cleanup() {
     glDeleteProgram(shaderProgram);
     shaderProgram = 0;
   }
+  if (resolveProgram) {
+    glDeleteProgram(resolveProgram);
+    resolveProgram = 0;
+  }
+  if (instancedProgram) {
+    glDeleteProgram(instancedProgram);
+    instancedProgram = 0;
+  }
+  if (instanceUBO) {
+    glDeleteBuffers(1, &instanceUBO);
+    instanceUBO = 0;
+    instanceCapacity = 0;
+  }
 }
 
 // Parameter setters
-void FireShader::setIntensity(float value) { intensity = value; }
+void FireShader::setIntensity(float value) {
+  intensity = value;
+  updateMaterial();
+}
 
-void FireShader::setSpeed(float value) { speed = value; }
+void FireShader::setSpeed(float value) {
+  speed = value;
+  updateMaterial();
+  octaveCache.invalidate();
+}
 
-void FireShader::setOctaves(int value) { octaves = value; }
+void FireShader::setOctaves(int value) {
+  octaves = value;
+  updateMaterial();
+  octaveCache.invalidate();
+}
 
-void FireShader::setScale(float value) { scale = value; }
+void FireShader::setScale(float value) {
+  scale = value;
+  updateMaterial();
+  octaveCache.invalidate();
+}
 
 // Parameter getters
 float FireShader::getIntensity() const { return intensity; }
@@ -203,3 +691,17 @@ int FireShader::getOctaves() const { return octaves; }
 float FireShader::getScale() const { return scale; }
 
 int FireShader::getNoiseType() const { return noise_type; }
+
+bool FireShader::isDynamicResolution() const { return dynamicResolution; }
+
+float FireShader::getRenderScale() const {
+  return dynamicResolution ? dynamicRes.getRenderScale() : 1.0f;
+}
+
+float FireShader::getLastGpuTime() const { return dynamicRes.getLastGpuTime(); }
+
+bool FireShader::isMultiRateOctaves() const { return multiRateOctaves; }
+
+bool FireShader::isInstanced() const { return instanced; }
+
+size_t FireShader::getInstanceCount() const { return instances.size(); }
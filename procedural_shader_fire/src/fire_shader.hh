@@ -1,8 +1,47 @@
 #pragma once
 
+#include "dynamic_resolution.hh"
+#include "octave_cache.hh"
+#include "render_state.hh"
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <string>
+#include <vector>
+
+// Fires per instanced draw call; larger sets are split into batches
+#define MAX_FIRE_INSTANCES 256
+
+// One fire of an instanced batch, laid out to match the std140 block in
+// fire_instanced_vertex.glsl
+struct FireInstance {
+  float centerX, centerY;      // Screen-space bounds in NDC
+  float halfWidth, halfHeight;
+  float intensity;
+  float speed;
+  float scale;
+  float seed;                  // Offsets the animation phase
+  int octaves;
+  int padding[3];
+};
+
+// Fire parameters, std140 layout of the FireMaterial block
+struct FireMaterial {
+  float intensity;
+  float speed;
+  float scale;
+  int octaves;
+  int noiseType;
+  int padding[3];
+};
+
+// Result of FireShader::compareOctaveCache
+struct OctaveCacheReport {
+  float fullGpuMs;   // Mean GPU time per frame, full evaluation
+  float cachedGpuMs; // Mean GPU time per frame, cache refresh included
+  float rmse;        // Root-mean-square RGB error, 0..1
+  float maxError;    // Largest per-channel error, 0..1
+  float psnr;        // dB, infinite when the images match
+};
 
 class FireShader {
 private:
@@ -10,15 +49,49 @@ private:
   GLuint VAO, VBO, EBO;
 
   // Uniform locations
-  GLint u_time_loc;
-  GLint u_intensity_loc;
-  GLint u_speed_loc;
-  GLint u_octaves_loc;
-  GLint u_scale_loc;
   GLint u_mouse_loc;
-  GLint u_noise_type_loc;
+  GLint u_jitter_loc;
   int noise_type;         // 0 = simplex, 1 = perlin
 
+  // Dynamic resolution with temporal upsampling
+  DynamicResolution dynamicRes;
+  bool dynamicResolution;
+  float temporalFeedback;
+  GLuint resolveProgram;
+  GLint r_current_loc;
+  GLint r_history_loc;
+  GLint r_current_texel_loc;
+  GLint r_scene_uv_scale_loc;
+  GLint r_jitter_offset_loc;
+  GLint r_feedback_loc;
+  GLint r_unpremultiply_loc;
+
+  // Multi-rate octave evaluation
+  OctaveCache octaveCache;
+  bool multiRateOctaves;
+  int coarseOctaves;
+  int octaveMode;            // Last values sent to the program, -1 if none
+  int uploadedCoarseOctaves;
+  GLint u_octave_mode_loc;
+  GLint u_coarse_octaves_loc;
+  GLint u_octave_cache_loc;
+  GLint u_cache_time_loc;
+  GLint u_cache_margin_loc;
+
+  // Instanced rendering
+  GLuint instancedProgram;
+  GLuint instanceUBO;
+  size_t instanceCapacity;
+  std::vector<FireInstance> instances;
+  bool instanced;
+  GLint i_jitter_loc;
+
+  // Shared render state; frame and material data live in uniform buffers
+  // that are only re-sent when their contents change
+  RenderState state;
+  UniformBuffer frameBlock;
+  UniformBuffer materialBlock;
+
   // Fire parameters
   float intensity;
   float speed;
@@ -27,9 +100,22 @@ private:
 
   // Helper methods
   bool compileShader(GLuint shader, const char *source, const char *type);
-  bool linkProgram();
+  bool linkProgram(GLuint program);
+  GLuint buildProgram(const char *vertexPath, const char *fragmentPath,
+                      const std::string &defines = "");
   void setupGeometry();
   void getUniformLocations();
+  void updateMaterial();
+  void setFrameTime(float currentTime);
+  void setOctaveMode(int mode);
+  DrawCommand quadCommand(GLuint program);
+  void drawFire(float currentTime);
+  void updateOctaveCache(float currentTime);
+  void drawInstances(float currentTime);
+  void drawScene(float currentTime);
+  void setJitter(float x, float y);
+  void drawResolve(GLuint current, GLuint history, float feedback);
+  void renderScaled(float currentTime);
 
 public:
   FireShader();
@@ -40,6 +126,24 @@ public:
   void cleanup();
   void setMousePosition(float x, float y); // Added mouse position setter
   void toggleNoiseType(); // Added to toggle noise type
+  void setNoiseType(int type); // 0 = simplex, 1 = perlin
+  void setDynamicResolution(bool enabled);
+  void toggleDynamicResolution();
+  void setTargetGpuTime(float ms);
+  void setMultiRateOctaves(bool enabled);
+  void toggleMultiRateOctaves();
+  void setCoarseOctaves(int value);
+  void setOctaveRefreshFrames(int frames);
+
+  // Instanced mode draws every fire in the set with one call per batch of
+  // MAX_FIRE_INSTANCES instead of the single full-screen fire
+  void setInstances(const std::vector<FireInstance> &fires);
+  void setInstanced(bool enabled);
+  void toggleInstanced();
+
+  // Renders the full and the cached evaluation offscreen over a run of
+  // frames at the current viewport size and compares them
+  OctaveCacheReport compareOctaveCache(float startTime, int frames);
 
   // Parameter setters
   void setIntensity(float value);
@@ -53,4 +157,10 @@ public:
   int getOctaves() const;
   float getScale() const;
   int getNoiseType() const;
+  bool isDynamicResolution() const;
+  float getRenderScale() const;
+  float getLastGpuTime() const;
+  bool isMultiRateOctaves() const;
+  bool isInstanced() const;
+  size_t getInstanceCount() const;
 };
\ No newline at end of file
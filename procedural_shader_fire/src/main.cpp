@@ -3,6 +3,7 @@
 #include <GLFW/glfw3.h>
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 // Global fire shader pointer for callbacks
 FireShader *g_fireShader = nullptr;
@@ -14,11 +15,40 @@ void printControls() {
   std::cout << "Noise Octaves: Z-C keys (3, 6, 8)" << std::endl;
   std::cout << "Fire Scale: A-D keys (2.0x - 4.0x)" << std::endl;
   std::cout << "Toggle Noise Type: N key" << std::endl;
+  std::cout << "Toggle Dynamic Resolution: V key" << std::endl;
+  std::cout << "Toggle Multi-Rate Octaves: M key" << std::endl;
+  std::cout << "Compare Multi-Rate vs Full Octaves: P key" << std::endl;
+  std::cout << "Toggle Instanced Fires: I key" << std::endl;
   std::cout << "Reset to defaults: SPACE" << std::endl;
   std::cout << "Exit: ESC" << std::endl;
   std::cout << "================================\n" << std::endl;
 }
 
+// Lays out a grid of small fires with varied parameters for instanced mode
+std::vector<FireInstance> createFireGrid(int columns, int rows) {
+  std::vector<FireInstance> fires;
+  float cellWidth = 2.0f / columns;
+  float cellHeight = 2.0f / rows;
+
+  for (int row = 0; row < rows; row++) {
+    for (int column = 0; column < columns; column++) {
+      int index = row * columns + column;
+      FireInstance fire = {};
+      fire.centerX = -1.0f + (column + 0.5f) * cellWidth;
+      fire.centerY = -1.0f + (row + 0.5f) * cellHeight;
+      fire.halfWidth = cellWidth * 0.4f;
+      fire.halfHeight = cellHeight * 0.45f;
+      fire.intensity = 1.0f + 0.25f * (index % 4);
+      fire.speed = 0.75f + 0.25f * (index % 3);
+      fire.scale = 2.0f + (index % 5) * 0.5f;
+      fire.seed = index * 1.618f;
+      fire.octaves = 4 + index % 3;
+      fires.push_back(fire);
+    }
+  }
+  return fires;
+}
+
 void keyCallback(GLFWwindow *window, int key, int scancode, int action,
                  int mods) {
   if (!g_fireShader)
@@ -102,6 +132,42 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action,
                 << std::endl;
     break;
 
+    // Toggle dynamic resolution
+    case GLFW_KEY_V:
+      g_fireShader->toggleDynamicResolution();
+      std::cout << "Dynamic resolution: "
+                << (g_fireShader->isDynamicResolution() ? "On" : "Off")
+                << std::endl;
+      break;
+
+    // Toggle multi-rate octave evaluation
+    case GLFW_KEY_M:
+      g_fireShader->toggleMultiRateOctaves();
+      std::cout << "Multi-rate octaves: "
+                << (g_fireShader->isMultiRateOctaves() ? "On" : "Off")
+                << std::endl;
+      break;
+
+    // Compare multi-rate against full evaluation
+    case GLFW_KEY_P: {
+      OctaveCacheReport report = g_fireShader->compareOctaveCache(
+          static_cast<float>(glfwGetTime()), 120);
+      std::cout << "Full octaves: " << report.fullGpuMs << " ms, multi-rate: "
+                << report.cachedGpuMs << " ms" << std::endl;
+      std::cout << "RMSE: " << report.rmse << ", max error: "
+                << report.maxError << ", PSNR: " << report.psnr << " dB"
+                << std::endl;
+      break;
+    }
+
+    // Toggle instanced fires
+    case GLFW_KEY_I:
+      g_fireShader->toggleInstanced();
+      std::cout << "Instanced fires: "
+                << (g_fireShader->isInstanced() ? "On" : "Off") << " ("
+                << g_fireShader->getInstanceCount() << " fires)" << std::endl;
+      break;
+
     // Reset to defaults
     case GLFW_KEY_SPACE:
       g_fireShader->setIntensity(1.5f);
@@ -219,6 +285,8 @@ int main() {
     return -1;
   }
 
+  fireShader.setInstances(createFireGrid(8, 4));
+
   // Setup callbacks
   glfwSetKeyCallback(window, keyCallback);
   glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
@@ -235,7 +303,11 @@ int main() {
     double currentTime = glfwGetTime();
     frameCount++;
     if (currentTime - lastTime >= 1.0) {
-      std::cout << "FPS: " << frameCount << std::endl;
+      std::cout << "FPS: " << frameCount;
+      if (fireShader.isDynamicResolution())
+        std::cout << " (scale " << fireShader.getRenderScale() << ", fire "
+                  << fireShader.getLastGpuTime() << " ms)";
+      std::cout << std::endl;
       frameCount = 0;
       lastTime = currentTime;
     }
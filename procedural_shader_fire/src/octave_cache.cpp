@@ -0,0 +1,138 @@
+#include "octave_cache.hh"
+#include <iostream>
+
+OctaveCache::OctaveCache()
+    : outputWidth(0), outputHeight(0), width(0), height(0), current(0),
+      band(0), valid(false), refreshFrames(4), resolution(0.25f),
+      margin(0.25f) {
+  cacheFBO[0] = cacheFBO[1] = 0;
+  cacheTexture[0] = cacheTexture[1] = 0;
+  buildTime[0] = buildTime[1] = 0.0f;
+}
+
+OctaveCache::~OctaveCache() { cleanup(); }
+
+void OctaveCache::releaseTargets() {
+  for (int i = 0; i < 2; i++) {
+    if (cacheFBO[i]) {
+      glDeleteFramebuffers(1, &cacheFBO[i]);
+      cacheFBO[i] = 0;
+    }
+    if (cacheTexture[i]) {
+      glDeleteTextures(1, &cacheTexture[i]);
+      cacheTexture[i] = 0;
+    }
+  }
+  outputWidth = outputHeight = 0;
+  invalidate();
+}
+
+void OctaveCache::cleanup() { releaseTargets(); }
+
+bool OctaveCache::resize(int outWidth, int outHeight) {
+  if (outWidth == outputWidth && outHeight == outputHeight && cacheFBO[0])
+    return true;
+
+  releaseTargets();
+  if (outWidth <= 0 || outHeight <= 0)
+    return false;
+
+  float extent = resolution * (1.0f + 2.0f * margin);
+  width = static_cast<int>(outWidth * extent + 0.5f);
+  height = static_cast<int>(outHeight * extent + 0.5f);
+  if (width < 1)
+    width = 1;
+  if (height < 1)
+    height = 1;
+
+  for (int i = 0; i < 2; i++) {
+    // Noise values are signed, so a float format is required
+    glGenTextures(1, &cacheTexture[i]);
+    glBindTexture(GL_TEXTURE_2D, cacheTexture[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA,
+                 GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &cacheFBO[i]);
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO[i]);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           cacheTexture[i], 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      std::cerr << "Octave cache framebuffer incomplete" << std::endl;
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      releaseTargets();
+      return false;
+    }
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  outputWidth = outWidth;
+  outputHeight = outHeight;
+  return true;
+}
+
+int OctaveCache::pendingBands() const {
+  return valid ? 1 : refreshFrames - band;
+}
+
+void OctaveCache::beginBand(float currentTime) {
+  // While invalid the target being sampled is the one being built
+  int target = valid ? 1 - current : current;
+  if (band == 0)
+    buildTime[target] = currentTime;
+
+  int y0 = height * band / refreshFrames;
+  int y1 = height * (band + 1) / refreshFrames;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO[target]);
+  glViewport(0, 0, width, height);
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(0, y0, width, y1 - y0);
+}
+
+void OctaveCache::endBand() {
+  glDisable(GL_SCISSOR_TEST);
+
+  band++;
+  if (band < refreshFrames)
+    return;
+
+  band = 0;
+  if (valid)
+    current = 1 - current;
+  valid = true;
+}
+
+void OctaveCache::invalidate() {
+  valid = false;
+  band = 0;
+}
+
+bool OctaveCache::isValid() const { return valid; }
+
+GLuint OctaveCache::getTexture() const { return cacheTexture[current]; }
+
+float OctaveCache::getCacheTime() const { return buildTime[current]; }
+
+float OctaveCache::getMargin() const { return margin; }
+
+float OctaveCache::getBuildTime() const {
+  return buildTime[valid ? 1 - current : current];
+}
+
+void OctaveCache::setRefreshFrames(int frames) {
+  refreshFrames = frames < 1 ? 1 : frames;
+  invalidate();
+}
+
+int OctaveCache::getRefreshFrames() const { return refreshFrames; }
+
+void OctaveCache::setResolution(float value) {
+  resolution = value;
+  releaseTargets();
+}
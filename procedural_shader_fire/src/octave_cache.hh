@@ -0,0 +1,51 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Low-resolution cache of the coarse fire octaves. Two targets are kept: the
+// complete one is sampled while the other is rebuilt a horizontal band per
+// frame, so a full refresh is spread evenly over refreshFrames frames.
+class OctaveCache {
+private:
+  GLuint cacheFBO[2], cacheTexture[2];
+  float buildTime[2]; // u_time each target was evaluated at
+
+  int outputWidth, outputHeight;
+  int width, height;
+  int current;        // Complete target being sampled
+  int band;           // Next band of the target under construction
+  bool valid;
+
+  int refreshFrames;  // Frames per full refresh
+  float resolution;   // Cache size relative to the output, per axis
+  float margin;       // Extra UV coverage on each side for reprojection
+
+  void releaseTargets();
+
+public:
+  OctaveCache();
+  ~OctaveCache();
+
+  void cleanup();
+
+  // Allocates targets for the given output size; returns false on failure
+  bool resize(int outWidth, int outHeight);
+
+  // Bands still to draw this frame: one normally, all of them after an
+  // invalidation so the cache is never sampled half-built
+  int pendingBands() const;
+  void beginBand(float currentTime);
+  void endBand();
+
+  void invalidate();
+  bool isValid() const;
+
+  GLuint getTexture() const;
+  float getCacheTime() const;
+  float getMargin() const;
+  float getBuildTime() const; // u_time of the target under construction
+
+  void setRefreshFrames(int frames);
+  int getRefreshFrames() const;
+  void setResolution(float value);
+};